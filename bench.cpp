@@ -0,0 +1,433 @@
+// Project Identifier: 50EB44D3F029ED934858FFFCEAC3547C68768FC9
+
+// Benchmark driver for project1.cpp.
+// It generates 'S' and 'C' dictionaries of the requested sizes, then times
+// readDict(), buildNeighborIndex(), search() and output() separately for
+// stack and queue mode and every combination of change, length and swap.
+// One CSV row is written per run, so results from two builds can be diffed.
+// With --modes it instead times the scan's similarity test for each of the
+// seven mode sets, specialized at compile time against the version that
+// reads the mode flags on every call.
+//
+// Build: g++ -std=c++17 -O3 -DNDEBUG -pthread bench.cpp -o bench
+
+#define LETTERMAN_NO_MAIN
+#include "project1.cpp"
+
+#include <chrono>
+#include <limits>
+#include <random>
+
+
+struct BenchConfig {
+    std::vector<size_t> sizes = {10000, 100000, 1000000};
+    size_t minLength = 3;
+    size_t maxLength = 8;
+    size_t alphabetSize = 26;
+    // chance that a generated word is a one-letter edit of an earlier one
+    double density = 0.5;
+    std::string engine = "index";
+    std::string outFile = "bench.csv";
+    unsigned seed = 281;
+    bool modeSets = false;
+};
+
+struct BenchDictionary {
+    std::string format;
+    std::string text;
+    // words that are certain to be in the dictionary after expansion
+    std::vector<std::string> plainWords;
+};
+
+void getBenchOptions(int argc, char** argv, BenchConfig &config);
+std::vector<std::string> generateWords(size_t numWords, BenchConfig &config,
+                                       std::mt19937 &rng);
+BenchDictionary makeSimpleDictionary(std::vector<std::string> &words);
+BenchDictionary makeComplexDictionary(std::vector<std::string> &words,
+                                      std::mt19937 &rng);
+void runBenchmark(BenchDictionary &dict, BenchConfig &config, std::ostream &csv);
+void runModeSetBenchmark(BenchDictionary &dict, BenchConfig &config, std::ostream &csv);
+template <int modeSet>
+void timeModeSet(BenchDictionary &dict, BenchConfig &config, std::ostream &csv);
+
+int main(int argc, char** argv) {
+    BenchConfig config;
+    getBenchOptions(argc, argv, config);
+
+    std::ofstream csv(config.outFile);
+    if (!csv) {
+        std::cerr << "Benchmark output could not be opened: " << config.outFile << "\n";
+        exit(1);
+    }
+    if (config.modeSets) {
+        csv << "words,min_length,max_length,alphabet,modes,kept_words,queries,"
+            << "runtime_ms,specialized_ms,speedup,found\n";
+    }
+    else {
+        csv << "format,words,min_length,max_length,alphabet,density,engine,"
+            << "modes,container,kept_words,read_ms,index_ms,search_ms,output_ms,"
+            << "found,discovered,morph_length\n";
+    }
+
+    std::mt19937 rng(config.seed);
+    for (size_t numWords : config.sizes) {
+        std::vector<std::string> words = generateWords(numWords, config, rng);
+
+        BenchDictionary simpleDict = makeSimpleDictionary(words);
+        if (config.modeSets) {
+            runModeSetBenchmark(simpleDict, config, csv);
+            continue;
+        } // the scan is the same for both formats
+        runBenchmark(simpleDict, config, csv);
+
+        BenchDictionary complexDict = makeComplexDictionary(words, rng);
+        runBenchmark(complexDict, config, csv);
+    } // for (numWords)
+
+    return 0;
+}
+
+void getBenchOptions(int argc, char** argv, BenchConfig &config) {
+    int option_index = 0, option = 0;
+
+    struct option longOpts[] = {{ "sizes", required_argument, nullptr, 'n' },
+                                { "min-length", required_argument, nullptr, 'm' },
+                                { "max-length", required_argument, nullptr, 'x' },
+                                { "alphabet", required_argument, nullptr, 'a' },
+                                { "density", required_argument, nullptr, 'd' },
+                                { "engine", required_argument, nullptr, 'g' },
+                                { "out", required_argument, nullptr, 'o' },
+                                { "seed", required_argument, nullptr, 'r' },
+                                { "modes", no_argument, nullptr, 's' },
+                                { "help", no_argument, nullptr, 'h' },
+                                { nullptr, 0, nullptr, '\0' }};
+
+    while ((option = getopt_long(argc, argv, "n:m:x:a:d:g:o:r:sh",
+                                 longOpts, &option_index)) != -1) {
+        switch (option) {
+            case 'n': {
+                config.sizes.clear();
+                std::istringstream sizeList(optarg);
+                std::string size;
+                while (getline(sizeList, size, ',')) {
+                    config.sizes.push_back(std::stoul(size));
+                }
+                break;
+            }
+
+            case 'm':
+                config.minLength = std::stoul(optarg);
+                break;
+
+            case 'x':
+                config.maxLength = std::stoul(optarg);
+                break;
+
+            case 'a':
+                config.alphabetSize = std::stoul(optarg);
+                break;
+
+            case 'd':
+                config.density = std::stod(optarg);
+                break;
+
+            case 'g':
+                config.engine = optarg;
+                break;
+
+            case 'o':
+                config.outFile = optarg;
+                break;
+
+            case 'r':
+                config.seed = static_cast<unsigned>(std::stoul(optarg));
+                break;
+
+            case 's':
+                config.modeSets = true;
+                break;
+
+            case 'h':
+                std::cout << "Usage: \'./bench\n\t[--sizes | -n] <n1,n2,...>\n"
+                          <<                   "\t[--min-length | -m] <letters>\n"
+                          <<                   "\t[--max-length | -x] <letters>\n"
+                          <<                   "\t[--alphabet | -a] <1-26>\n"
+                          <<                   "\t[--density | -d] <0.0-1.0>\n"
+                          <<                   "\t[--engine | -g] <index | scan | probe>\n"
+                          <<                   "\t[--out | -o] <CSV file>\n"
+                          <<                   "\t[--seed | -r] <seed>\n"
+                          <<                   "\t[--modes | -s]\n"
+                          <<                   "\t[--help | -h]\'" << std::endl;
+                exit(0);
+
+            default:
+                std::cerr << "Unknown benchmark option\n";
+                exit(1);
+        }
+    }
+
+    if (config.minLength < 2 || config.maxLength < config.minLength) {
+        std::cerr << "Word lengths must satisfy 2 <= min-length <= max-length\n";
+        exit(1);
+    }
+
+    if (config.alphabetSize < 1 || config.alphabetSize > 26) {
+        std::cerr << "Alphabet size must be between 1 and 26\n";
+        exit(1);
+    }
+} // getBenchOptions()
+
+std::vector<std::string> generateWords(size_t numWords, BenchConfig &config,
+                                       std::mt19937 &rng) {
+    std::uniform_int_distribution<size_t> lengthDist(config.minLength, config.maxLength);
+    std::uniform_int_distribution<int> letterDist(0, static_cast<int>(config.alphabetSize) - 1);
+    std::uniform_real_distribution<double> chance(0.0, 1.0);
+
+    std::vector<std::string> words;
+    words.reserve(numWords);
+
+    // a ladder of changes from words[0] to words[length], so that every mode
+    // with --change has a real morph to find between the first two endpoints
+    std::string word(config.maxLength, 'a');
+    for (char &letter : word) {
+        letter = static_cast<char>('a' + letterDist(rng));
+    }
+    words.push_back(word);
+    for (size_t i = 0; i < word.size() && words.size() < numWords; ++i) {
+        char letter = word[i];
+        while (config.alphabetSize > 1 && letter == word[i]) {
+            letter = static_cast<char>('a' + letterDist(rng));
+        }
+        word[i] = letter;
+        words.push_back(word);
+    } // for (i)
+
+    while (words.size() < numWords) {
+        if (!words.empty() && chance(rng) < config.density) {
+            // one change, swap, insert or delete away from an earlier word
+            word = words[std::uniform_int_distribution<size_t>(0, words.size() - 1)(rng)];
+            size_t letterIdx = std::uniform_int_distribution<size_t>(0, word.size() - 1)(rng);
+            char letter = static_cast<char>('a' + letterDist(rng));
+
+            switch (rng() % 4) {
+                case 0:
+                    word[letterIdx] = letter;
+                    break;
+
+                case 1:
+                    if (letterIdx + 1 < word.size()) {
+                        std::swap(word[letterIdx], word[letterIdx + 1]);
+                    }
+                    break;
+
+                case 2:
+                    if (word.size() < config.maxLength) {
+                        word.insert(letterIdx, 1, letter);
+                    }
+                    break;
+
+                default:
+                    if (word.size() > config.minLength) {
+                        word.erase(letterIdx, 1);
+                    }
+                    break;
+            }
+        } // if the new word should have a neighbor
+        else {
+            word.resize(lengthDist(rng));
+            for (char &letter : word) {
+                letter = static_cast<char>('a' + letterDist(rng));
+            }
+        } // else: a random word
+
+        words.push_back(word);
+    } // while more words are needed
+
+    return words;
+} // generateWords()
+
+BenchDictionary makeSimpleDictionary(std::vector<std::string> &words) {
+    BenchDictionary dict;
+    dict.format = "S";
+    dict.plainWords = words;
+
+    dict.text = "S\n" + std::to_string(words.size()) + "\n// generated by bench\n";
+    for (std::string &word : words) {
+        dict.text += word;
+        dict.text += '\n';
+    }
+    return dict;
+} // makeSimpleDictionary()
+
+BenchDictionary makeComplexDictionary(std::vector<std::string> &words,
+                                      std::mt19937 &rng) {
+    BenchDictionary dict;
+    dict.format = "C";
+
+    std::string body;
+    for (std::string &word : words) {
+        // every fifth word or so uses one of the special characters
+        size_t special = rng() % 20;
+        if (special == 0) {
+            body += word + "&";
+        }
+        else if (special == 1) {
+            size_t letterIdx = rng() % word.size();
+            body += word.substr(0, letterIdx) + "[" + word[letterIdx] +
+                    static_cast<char>('a' + rng() % 26) + "]" + word.substr(letterIdx + 1);
+        }
+        else if (special == 2) {
+            body += word + "!";
+        }
+        else if (special == 3) {
+            body += word + "?";
+        }
+        else {
+            body += word;
+        }
+        body += '\n';
+
+        // reversal, swap and double keep the word itself, insert keeps
+        // it as its first variant
+        dict.plainWords.push_back(word);
+    } // for (word)
+
+    dict.text = "C\n" + std::to_string(words.size()) + "\n// generated by bench\n" + body;
+    return dict;
+} // makeComplexDictionary()
+
+void runBenchmark(BenchDictionary &dict, BenchConfig &config, std::ostream &csv) {
+    using Clock = std::chrono::steady_clock;
+    auto millis = [](Clock::time_point start, Clock::time_point end) {
+        return std::chrono::duration<double, std::milli>(end - start).count();
+    };
+
+    // the ends of the ladder from generateWords(), the same for every mode
+    std::string beginWord = dict.plainWords.front();
+    std::string endWord = dict.plainWords[std::min(dict.plainWords.size() - 1,
+                                                   beginWord.size())];
+
+    const char *modeSets[] = {"-c", "-l", "-p", "-cl", "-cp", "-lp", "-clp"};
+    const char *containers[] = {"-s", "-q"};
+
+    // output() is timed without a terminal behind it
+    int nullFd = open("/dev/null", O_WRONLY);
+
+    for (const char *modes : modeSets) {
+        for (const char *container : containers) {
+            std::vector<std::string> args = {"bench", container, modes,
+                                             "-b", beginWord, "-e", endWord,
+                                             "-n", config.engine};
+            std::vector<char *> argv;
+            for (std::string &arg : args) {
+                argv.push_back(&arg[0]);
+            }
+            argv.push_back(nullptr);
+
+            LetterManClass letterman;
+            optind = 0;
+            letterman.getOptions(static_cast<int>(args.size()), argv.data());
+            letterman.outputFd = nullFd;
+
+            Clock::time_point readStart = Clock::now();
+            letterman.parseDict(dict.text);
+            Clock::time_point indexStart = Clock::now();
+            letterman.buildNeighborIndex();
+            Clock::time_point searchStart = Clock::now();
+            bool morphFound = letterman.search();
+            size_t morphLength = letterman.path.size();
+            Clock::time_point outputStart = Clock::now();
+            letterman.printMorph(morphFound);
+            Clock::time_point outputEnd = Clock::now();
+
+            csv << dict.format << ',' << dict.plainWords.size() << ','
+                << config.minLength << ',' << config.maxLength << ','
+                << config.alphabetSize << ',' << config.density << ','
+                << config.engine << ',' << (modes + 1) << ','
+                << (container[1] == 's' ? "stack" : "queue") << ','
+                << letterman.numWords() << ','
+                << millis(readStart, indexStart) << ','
+                << millis(indexStart, searchStart) << ','
+                << millis(searchStart, outputStart) << ','
+                << millis(outputStart, outputEnd) << ','
+                << morphFound << ',' << letterman.numDiscovered << ','
+                << morphLength << "\n" << std::flush;
+        } // for (container)
+    } // for (modes)
+
+    close(nullFd);
+} // runBenchmark()
+
+void runModeSetBenchmark(BenchDictionary &dict, BenchConfig &config, std::ostream &csv) {
+    timeModeSet<changeBit>(dict, config, csv);
+    timeModeSet<lengthBit>(dict, config, csv);
+    timeModeSet<swapBit>(dict, config, csv);
+    timeModeSet<changeBit | lengthBit>(dict, config, csv);
+    timeModeSet<changeBit | swapBit>(dict, config, csv);
+    timeModeSet<lengthBit | swapBit>(dict, config, csv);
+    timeModeSet<changeBit | lengthBit | swapBit>(dict, config, csv);
+} // runModeSetBenchmark()
+
+template <int modeSet>
+void timeModeSet(BenchDictionary &dict, BenchConfig &config, std::ostream &csv) {
+    using Clock = std::chrono::steady_clock;
+
+    std::string modes = "-";
+    modes += (modeSet & changeBit) ? "c" : "";
+    modes += (modeSet & lengthBit) ? "l" : "";
+    modes += (modeSet & swapBit) ? "p" : "";
+
+    // request mode keeps every word, a begin and end word would let the 
+    // filter drop most of them, all but the anagrams for swap alone
+    std::vector<std::string> args = {"bench", "-q", modes, "-r", "/dev/null", 
+                                     "-n", "scan"};
+    std::vector<char *> argv;
+    for (std::string &arg : args) {
+        argv.push_back(&arg[0]);
+    }
+    argv.push_back(nullptr);
+
+    LetterManClass letterman;
+    optind = 0;
+    letterman.getOptions(static_cast<int>(args.size()), argv.data());
+    letterman.parseDict(dict.text);
+    letterman.buildNeighborIndex();
+
+    // the same query words for both versions, spread over the dictionary
+    size_t numQueries = std::min<size_t>(256, letterman.numWords());
+    std::vector<int> similarWords;
+    auto timeScan = [&](void (LetterManClass::*scan)(int, std::vector<int> &, bool),
+                        size_t &numFound) {
+        numFound = 0;
+        Clock::time_point start = Clock::now();
+        for (size_t i = 0; i < numQueries; i++) {
+            int queryIdx = static_cast<int>(i * letterman.numWords() / numQueries);
+            (letterman.*scan)(queryIdx, similarWords, false);
+            numFound += similarWords.size();
+        } // for (i)
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    };
+
+    // alternated and the best of five kept, so neither version is timed cold
+    size_t runtimeFound;
+    size_t specializedFound;
+    double runtimeMs = std::numeric_limits<double>::max();
+    double specializedMs = std::numeric_limits<double>::max();
+    for (int round = 0; round < 5; round++) {
+        runtimeMs = std::min(runtimeMs, timeScan(
+            &LetterManClass::scanNeighbors<false, runtimeModeSet>, runtimeFound));
+        specializedMs = std::min(specializedMs, timeScan(
+            &LetterManClass::scanNeighbors<false, modeSet>, specializedFound));
+    } // for (round)
+    if (runtimeFound != specializedFound) {
+        std::cerr << "Specialized scan disagrees for " << modes << "\n";
+        exit(1);
+    }
+
+    csv << dict.plainWords.size() << ',' << config.minLength << ','
+        << config.maxLength << ',' << config.alphabetSize << ','
+        << (modes.c_str() + 1) << ',' << letterman.numWords() << ','
+        << numQueries << ',' << runtimeMs << ',' << specializedMs << ','
+        << (specializedMs > 0 ? runtimeMs / specializedMs : 0.0) << ','
+        << specializedFound << "\n" << std::flush;
+} // timeModeSet()
@@ -8,20 +8,263 @@
 // word, to another word, etc., eventually leading to the ending word, 
 // making one change at a time.
 
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cerrno>
+#include <charconv>
+#include <chrono>
+#include <climits>
+#include <condition_variable>
 #include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <vector>
 #include <deque>
 #include <iostream>
+#include <list>
+#include <fstream>
+#include <sstream>
 #include <algorithm>
 #include <getopt.h>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define LETTERMAN_SIMD 1
+#endif
 
-struct Word {
-    std::string word = "";
-    int prevWordIdx = -1;
-    bool isDiscovered = false;
-}; 
+
+// Layout of a --build-cache file, every section is padded to 8 bytes:
+// header, word offsets[numWords + 1], word bytes,
+// graph offsets[numWords + 1], graph targets[numEdges]
+struct CacheHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t modeFlags;
+    uint64_t dictHash;
+    uint64_t numWords;
+    uint64_t numEdges;
+    uint64_t wordBytes;
+};
+
+// Splits the dictionary text into whitespace separated tokens the way 
+// operator>> would, handing out views instead of copies
+class DictScanner {
+    private:
+        std::string_view text;
+        size_t pos = 0;
+
+        void skipSpace();
+
+    public:
+        explicit DictScanner(std::string_view dictText);
+
+        char nextChar();
+        size_t nextNumber();
+        bool nextToken(std::string_view &token);
+        void skipLine();
+};
+
+enum ModificationMode { changeMode, swapMode, lengthMode };
+
+// bits of a mode set, the template argument the similarity tests and the 
+// scan are specialized on; runtimeModeSet reads the flags on every call
+const int changeBit = 1;
+const int swapBit = 2;
+const int lengthBit = 4;
+const int runtimeModeSet = 0;
+
+// counters behind --stats, atomic because the threaded search shares them
+struct RunStats {
+    double readMs = 0;
+    // part of readMs, summed over the workers when the load is threaded
+    double filterMs = 0;
+    double indexMs = 0;
+    double cacheMs = 0;
+    double searchMs = 0;
+    double outputMs = 0;
+
+    std::atomic<size_t> wordsRead{0};
+    std::atomic<size_t> wordsFiltered{0};
+    // indexed by changeMode, swapMode and lengthMode
+    std::atomic<size_t> modeChecks[3] = {};
+    std::atomic<size_t> modePasses[3] = {};
+    std::atomic<size_t> sizeRejections{0};
+
+    size_t numSearches = 0;
+    size_t numUpdates = 0;
+    double updateMs = 0;
+    size_t wordsDiscovered = 0;
+    size_t peakContainerSize = 0;
+    size_t longestPath = 0;
+    // levels of the --hybrid search, by the direction they were expanded in
+    size_t topDownLevels = 0;
+    size_t bottomUpLevels = 0;
+};
+
+// adds its own lifetime to *phaseMs, and does nothing without a target
+class PhaseTimer {
+    private:
+        double *phaseMs;
+        std::chrono::steady_clock::time_point start;
+
+    public:
+        explicit PhaseTimer(double *elapsedMs);
+        ~PhaseTimer();
+};
+
+// a word waiting in the --astar frontier, estimate is its depth plus 
+// the lower bound on the steps still needed to reach endWord
+struct AStarEntry {
+    int estimate;
+    int depth;
+    int wordIdx;
+};
+
+// orders the frontier so the top has the lowest estimate, then the 
+// deepest path, then the lowest index, which keeps the search deterministic
+struct AStarOrder {
+    bool operator()(const AStarEntry &entryA, const AStarEntry &entryB) const;
+};
+
+// a queue or stack search from one begin word, paused once every end 
+// word asked for so far is discovered, so later requests can resume it
+struct SearchTree {
+    int beginWordIdx;
+    bool stackIsSpecified;
+    std::vector<int> prevWordIdx;
+    std::vector<uint64_t> discoveredWords;
+    std::deque<int> searchContainer;
+    int numDiscovered;
+};
+
+// a run of expanded dictionary words on its way through the load pipeline
+struct DictChunk {
+    std::string letters;
+    std::vector<uint32_t> lengths;
+    // set by a worker for every word wordShouldInDict() keeps
+    std::vector<char> keep;
+};
+
+// one masked key of a word for the graph builder, sorted by hash so 
+// that equal keys end up side by side
+struct KeyEntry {
+    uint32_t hash;
+    uint32_t wordIdx;
+    // the ModificationMode that made the key
+    uint8_t mode;
+    // the letter masked, swapped or deleted, wholeWordKey for the key 
+    // of a whole word that deletions of longer words are matched against
+    uint16_t letterIdx;
+};
+
+const uint16_t wholeWordKey = UINT16_MAX;
+
+class LetterManClass;
+
+// hash and compare dictionary words by index, so a set of them costs 
+// no allocation per word
+struct WordIdxHash {
+    LetterManClass *letterman;
+    size_t operator()(uint32_t wordIdx) const;
+};
+
+struct WordIdxEqual {
+    LetterManClass *letterman;
+    bool operator()(uint32_t wordIdxA, uint32_t wordIdxB) const;
+};
+
+const char cacheMagic[8] = {'L', 'T', 'R', 'M', 'A', 'N', 'G', 'R'};
+const uint32_t cacheVersion = 2;
+const uint64_t hashSeed = 14695981039346656037ULL;
+// the length of a word removed by a request file update, no other 
+// word is ever within one letter of it, so every engine passes it by
+const uint32_t removedLength = UINT32_MAX;
+// a probe slot whose word was removed, lookups keep probing past it
+const uint32_t probeTombstone = UINT32_MAX;
+// a packed word holds 5 bits per letter, a to z as 1 to 26, first letter lowest
+const size_t packedMaxLetters = 12;
+// the lowest bit of each of the 12 letters
+const uint64_t packedLowBits = 0x0084210842108421ULL;
+// --hybrid goes bottom-up once the frontier holds more than 1/alpha of 
+// the edges left unexplored, and back top-down once a shrinking frontier 
+// holds less than 1/beta of the words; alpha is well below the usual 15 
+// because a word without a frontier neighbor costs a bottom-up step its 
+// whole neighbor lookup, which measured best on dense dictionaries
+const size_t hybridAlpha = 4;
+const size_t hybridBeta = 18;
+
+#ifdef LETTERMAN_SIMD
+// bit i is set when byte i of the two zero-padded slots is equal
+inline uint32_t equalMask16(const char *wordA, const char *wordB) {
+    __m128i bytesA = _mm_loadu_si128(reinterpret_cast<const __m128i *>(wordA));
+    __m128i bytesB = _mm_loadu_si128(reinterpret_cast<const __m128i *>(wordB));
+    return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytesA, bytesB))) & 0xFFFFu;
+} // equalMask16()
+
+inline uint32_t equalMask32Sse2(const char *wordA, const char *wordB) {
+    return equalMask16(wordA, wordB) | (equalMask16(wordA + 16, wordB + 16) << 16);
+} // equalMask32Sse2()
+
+__attribute__((target("avx2")))
+inline uint32_t equalMask32Avx2(const char *wordA, const char *wordB) {
+    __m256i bytesA = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(wordA));
+    __m256i bytesB = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(wordB));
+    return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(bytesA, bytesB)));
+} // equalMask32Avx2()
+#endif
+
+inline uint32_t lowBits(size_t numBits) {
+    return numBits >= 32 ? 0xFFFFFFFFu : (1u << numBits) - 1;
+} // lowBits()
+
+inline bool testBit(const std::vector<uint64_t> &bits, size_t bitIdx) {
+    return (bits[bitIdx >> 6] >> (bitIdx & 63)) & 1;
+} // testBit()
+
+inline void setBit(std::vector<uint64_t> &bits, size_t bitIdx) {
+    bits[bitIdx >> 6] |= uint64_t(1) << (bitIdx & 63);
+} // setBit()
+
+class ThreadPool {
+    private:
+        std::vector<std::thread> workers;
+        std::mutex poolMutex;
+        std::condition_variable wakeWorkers;
+        std::condition_variable workersDone;
+
+        const std::function<void(size_t)> *job = nullptr;
+        size_t numJobTasks = 0;
+        std::atomic<size_t> nextTask{0};
+        size_t generation = 0;
+        size_t numBusyWorkers = 0;
+        bool stopping = false;
+
+        void work();
+
+    public:
+        explicit ThreadPool(size_t numThreads);
+        ~ThreadPool();
+
+        size_t size();
+        // calls task(i) for every i in [0, numTasks), the caller helps out
+        void run(size_t numTasks, const std::function<void(size_t)> &task);
+};
 
 class LetterManClass {
     private:
@@ -32,6 +275,10 @@ class LetterManClass {
         int endWordIdx = -1;
 
         std::string outputFormat;
+        std::string neighborEngine;
+        std::string buildCacheFile;
+        std::string cacheFile;
+        std::string requestFile;
         bool queueIsSpecified = false;
         bool stackIsSpecified = false;
         bool outputIsSpecified = false;
@@ -40,32 +287,258 @@ class LetterManClass {
         bool lengthIsSpecified = false;
         bool beginIsSpecified = false;
         bool endIsSpecified = false;
+        bool bidirectionalIsSpecified = false;
+        bool dedupIsSpecified = false;
+        bool astarIsSpecified = false;
+        bool hybridIsSpecified = false;
+        bool allShortestIsSpecified = false;
+        bool limitIsSpecified = false;
+        // at most this many morphs are printed by --all-shortest
+        size_t morphLimit = SIZE_MAX;
+        // bytes the paused searches of request mode may keep, 0 turns them off
+        size_t treeCacheBytes = size_t(64) << 20;
+        size_t numThreads = 1;
+        // null unless --stats is given, so every counter hides behind one test
+        std::unique_ptr<RunStats> stats;
+        bool useNeighborIndex = false;
+        bool useNeighborGraph = false;
+        bool useProbeTable = false;
+
+        // CSR adjacency, either mapped from a cache file or built for one
+        const char *cacheData = nullptr;
+        size_t cacheSize = 0;
+        const uint32_t *graphOffsets = nullptr;
+        const uint32_t *graphTargets = nullptr;
+        uint64_t dictHash = 0;
+
+        // sorted once per begin/end pair for wordShouldInDict()
+        std::string sortedBegin;
+        std::string sortedEnd;
+        std::string sortedWord;
+        // words the load pipeline already put into the neighbor index
+        size_t numBucketedWords = 0;
+
+        // union-find over the similarity graph, a root's size is its component's
+        std::vector<int> componentParent;
+        std::vector<int> componentSize;
+        // a removal can split a component, after one the labels only 
+        // prove that two words are apart, not how large a component is
+        bool componentsAreExact = true;
+        // words a request line removed, their slots stay behind as removedLength
+        size_t numRemovedWords = 0;
+
+        std::unordered_set<uint32_t, WordIdxHash, WordIdxEqual> uniqueWords;
+        size_t numDuplicates = 0;
+
+        // the whole dictionary text, mapped when stdin is a file
+        std::string_view dictText;
+        std::string dictBuffer;
+        const char *dictMapped = nullptr;
+        size_t dictMappedSize = 0;
+
+        // the bidirectional search walks back from endWord with these
+        std::vector<int> nextWordIdx;
+        std::vector<uint64_t> backwardWords;
+        std::vector<int> searchDepth;
+
+        // the BFS DAG of --all-shortest: the words of each level back to 
+        // back, and the children of a word at the next level, which are 
+        // dagChildren[first, second) of its dagChildRange
+        std::vector<int> levelWords;
+        std::vector<size_t> levelOffsets;
+        std::vector<int> dagChildren;
+        std::vector<std::pair<uint32_t, uint32_t>> dagChildRange;
+        // shortest morphs from a word on to endWord, 0 for a dead end
+        std::vector<uint64_t> morphCounts;
+
+        // the hybrid search marks its frontier here for its bottom-up steps
+        std::vector<uint64_t> frontierWords;
+
+        // the threaded search claims words for the earliest frontier word
+        std::unique_ptr<ThreadPool> threadPool;
+        std::vector<std::atomic<int>> frontierClaim;
+        std::vector<std::vector<int>> frontierNeighbors;
+
+        // the specializations for the mode set and --stats, chosen once 
+        // by getOptions() so the scan's inner loop has no mode branches
+        bool (LetterManClass::*similarWordsTest)(std::string_view, std::string_view) = nullptr;
+        void (LetterManClass::*scanNeighborsStep)(int, std::vector<int> &, bool) = nullptr;
+        void (LetterManClass::*scanDictionaryStep)(int, std::deque<int> &) = nullptr;
+        int (LetterManClass::*scanParentStep)(size_t, const std::vector<int> &) = nullptr;
+
+        // words of at most paddedSlot letters, zero padded, for the scan kernel
+        size_t paddedSlot = 0;
+        std::vector<char> paddedWords;
+        uint32_t (*equalMask)(const char *, const char *) = nullptr;
+
+        // every word packed into one uint64_t, empty unless all of them fit
+        std::vector<uint64_t> packedWords;
+
+        // words sharing a key are identical except at the masked position
+        std::unordered_map<std::string, std::vector<int>> changeBuckets;
+        // words sharing a key are identical or differ by swapping the marked pair
+        std::unordered_map<std::string, std::vector<int>> swapBuckets;
+        // longer words keyed by each of their single-letter deletions
+        std::unordered_map<std::string, std::vector<int>> deletionBuckets;
+        std::unordered_map<std::string, std::vector<int>> wordBuckets;
+        std::vector<int> neighbors;
+
+        // open addressing over the dictionary for the probe engine, a slot 
+        // holds the first index of its word plus one, zero when empty
+        std::vector<uint32_t> probeSlots;
+        size_t probeMask = 0;
+        // the next index holding the same word, or -1
+        std::vector<int> nextSameWord;
+        // every letter used by the dictionary, candidates are built from these
+        std::string alphabet;
+
+        // one answer is formatted here, then handed to write(2) at once
+        std::string outputBuffer;
+
+        // paused searches of request mode, the most recently used first
+        std::list<SearchTree> searchTrees;
 
     public:
-        std::vector<Word> dictionary;
+        ~LetterManClass();
+
+        // the dictionary as a structure of arrays, word i is the 
+        // wordLengths[i] letters of wordLetters starting at wordOffsets[i]
+        std::vector<char> wordLetters;
+        std::vector<uint32_t> wordOffsets;
+        std::vector<uint32_t> wordLengths;
+        std::vector<int> prevWordIdx;
+        // bit i is set once word i is discovered by the current search
+        std::vector<uint64_t> discoveredWords;
         bool beginWordFound = false;
         bool endWordFound = false;
         int numDiscovered = 0;
         
         std::deque<int> path;
+        int outputFd = STDOUT_FILENO;
 
         void getOptions(int argc, char** argv);
-        bool wordShouldInDict(std::string &newWord);
-        void checkBeginEnd(std::string &wordToPush, int &numWordsInDict);
+        bool wordShouldInDict(std::string_view newWord, std::string &sortedLetters);
+        void checkBeginEnd(std::string_view wordToPush, int &numWordsInDict);
+        size_t numWords();
+        std::string_view wordAt(size_t wordIdx);
+        void addWord(std::string_view newWord);
+        void removeLastWord();
+        void pushWord(std::string_view newWord, int &numWordsInDict);
+        void commitWord(std::string_view newWord, int &numWordsInDict);
+        bool cacheIsSpecified();
+        bool requestsAreSpecified();
+        uint64_t hashBytes(const char *bytes, size_t numBytes, uint64_t hash);
+        uint32_t modeFlags();
+        void loadDictText();
         void readDict();
-        bool areSimilarWords(Word &investingWord, Word &currentWord);
+        void parseDict(std::string_view text);
+        template <typename WordSink>
+        void scanDictWords(DictScanner &scanner, char dictType, size_t numLines, 
+                           WordSink &&pushToken);
+        void pipelineDict(DictScanner &scanner, char dictType, size_t numLines, 
+                          int &numWordsInDict);
+        void commitChunk(DictChunk &chunk, int &numWordsInDict);
+        void loadCache();
+        void writeCache();
+        void runParallel(size_t numTasks, const std::function<void(size_t)> &task);
+        size_t countKeys(size_t wordIdx);
+        void emitKeys(size_t wordIdx, KeyEntry *entries, std::vector<uint64_t> &prefixHash);
+        bool keysAreSimilar(const KeyEntry &entryA, const KeyEntry &entryB);
+        void buildSimilarityGraph(std::vector<uint32_t> &offsets, 
+                                  std::vector<uint32_t> &targets);
+        template <int modeSet>
+        void selectModeSet();
+        template <int modeSet>
+        bool modeIsOn(int modeBit);
+        bool areSimilarWords(std::string_view investingWord, std::string_view currentWord);
+        template <int modeSet>
+        bool areSimilarWords(std::string_view investingWord, std::string_view currentWord);
+        void padWords();
+        bool packWord(std::string_view word, uint64_t &packedWord);
+        bool packWords();
+        template <int modeSet>
+        bool arePackedWordsSimilar(size_t investingIdx, size_t currentIdx);
+        template <int modeSet>
+        bool arePaddedWordsSimilar(size_t investingIdx, size_t currentIdx);
+        // countStats is a template argument so the scan without --stats 
+        // carries no counting code at all
+        template <bool countStats, int modeSet>
+        bool areSimilarIndices(size_t investingIdx, size_t currentIdx);
+        void countSimilarity(size_t investingIdx, size_t currentIdx, bool similar);
+        void makeSwapKey(std::string_view word, size_t letterIdx, 
+                         std::string &key);
+        void buildNeighborIndex();
+        void bucketWord(size_t wordIdx, ModificationMode mode, bool adding);
+        void buildProbeTable();
+        int probeWord(std::string_view word);
+        size_t addProbedWords(std::string_view candidate, std::vector<int> &similarWords);
+        void probeNeighbors(int currentWordIdx, std::vector<int> &similarWords);
+        void insertProbeWord(size_t wordIdx);
+        void eraseProbeWord(std::string_view word);
+        void findNeighbors(int currentWordIdx, std::vector<int> &similarWords);
+        template <bool countStats, int modeSet>
+        void scanNeighbors(int currentWordIdx, std::vector<int> &similarWords, 
+                           bool undiscoveredOnly);
+        template <bool countStats, int modeSet>
+        void scanDictionary(int currentWordIdx, std::deque<int> &searchContainer);
+        template <bool countStats, int modeSet>
+        int scanParent(size_t wordIdx, const std::vector<int> &frontier);
+        int probeParent(std::string_view candidate);
+        int findFrontierParent(int wordIdx);
+        void startSearch();
         bool search();
-        std::string printModification(Word &wordToModify, Word &wordAfterModify);
+        bool bidirectionalSearch();
+        int estimateDistance(int wordIdx);
+        bool astarSearch();
+        bool hybridSearch();
+        bool allShortestSearch();
+        bool threadedSearch();
+        void appendNumber(size_t number);
+        void printModification(std::string_view wordToModify, 
+                               std::string_view wordAfterModify);
+        void appendMorph();
+        void appendAllShortest();
+        void printMorph(bool morphFound);
+        void writeOutput();
         void output();
+        int findComponent(int wordIdx);
+        void labelComponents();
+        void joinComponents(int wordIdxA, int wordIdxB);
+        size_t insertWord(std::string_view newWord);
+        size_t eraseWord(int wordIdx);
+        void answerRequests();
+        void updateDictionary(std::vector<std::string> &command, 
+                              std::unordered_map<std::string, std::vector<int>> &wordIndex);
+        void answerRequest(std::unordered_map<std::string, std::vector<int>> &wordIndex);
+        SearchTree &findSearchTree();
+        void growSearchTree(SearchTree &tree);
+        void trimSearchTrees();
+        void answerFromTree();
+        void printStats();
 
 };
 
+// bench.cpp compiles this file into its own driver
+#ifndef LETTERMAN_NO_MAIN
 int main(int argc, char** argv) {
     LetterManClass letterman;
 
     letterman.getOptions(argc, argv);
 
-    letterman.readDict();
+    if (letterman.cacheIsSpecified()) {
+        letterman.loadCache();
+    }
+    else {
+        letterman.readDict();
+    }
+
+    if (letterman.requestsAreSpecified()) {
+        letterman.buildNeighborIndex();
+        letterman.writeCache();
+        letterman.answerRequests();
+        letterman.printStats();
+        return 0;
+    } // if begin and end words come from the request file
 
     if (!letterman.beginWordFound) {
         std::cerr << "Beginning word does not exist in the dictionary\n";
@@ -77,10 +550,147 @@ int main(int argc, char** argv) {
         exit (1);
     }
 
+    letterman.buildNeighborIndex();
+
+    letterman.writeCache();
+
     letterman.output();
 
+    letterman.printStats();
+
     return 0;
 }
+#endif
+
+ThreadPool::ThreadPool(size_t numThreads) {
+    // the thread calling run() is the last worker
+    for (size_t i = 1; i < numThreads; i++) {
+        workers.emplace_back(&ThreadPool::work, this);
+    }
+} // ThreadPool()
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> guard(poolMutex);
+        stopping = true;
+    }
+    wakeWorkers.notify_all();
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+} // ~ThreadPool()
+
+size_t ThreadPool::size() {
+    return workers.size() + 1;
+} // size()
+
+void ThreadPool::work() {
+    size_t seenGeneration = 0;
+    std::unique_lock<std::mutex> poolLock(poolMutex);
+
+    while (true) {
+        wakeWorkers.wait(poolLock, [&] { 
+            return stopping || generation != seenGeneration; 
+        });
+        if (stopping) {
+            return;
+        }
+        seenGeneration = generation;
+        const std::function<void(size_t)> &task = *job;
+        size_t numTasks = numJobTasks;
+        poolLock.unlock();
+
+        for (size_t i = nextTask++; i < numTasks; i = nextTask++) {
+            task(i);
+        }
+
+        poolLock.lock();
+        if (--numBusyWorkers == 0) {
+            workersDone.notify_one();
+        }
+    } // while the pool is alive
+} // work()
+
+void ThreadPool::run(size_t numTasks, const std::function<void(size_t)> &task) {
+    if (workers.empty() || numTasks <= 1) {
+        for (size_t i = 0; i < numTasks; i++) {
+            task(i);
+        }
+        return;
+    } // not worth waking anyone
+
+    {
+        std::lock_guard<std::mutex> guard(poolMutex);
+        job = &task;
+        numJobTasks = numTasks;
+        nextTask = 0;
+        numBusyWorkers = workers.size();
+        generation++;
+    }
+    wakeWorkers.notify_all();
+
+    for (size_t i = nextTask++; i < numTasks; i = nextTask++) {
+        task(i);
+    }
+
+    std::unique_lock<std::mutex> poolLock(poolMutex);
+    workersDone.wait(poolLock, [&] { return numBusyWorkers == 0; });
+    job = nullptr;
+} // run()
+
+PhaseTimer::PhaseTimer(double *elapsedMs) : phaseMs(elapsedMs) {
+    if (phaseMs != nullptr) {
+        start = std::chrono::steady_clock::now();
+    }
+} // PhaseTimer()
+
+PhaseTimer::~PhaseTimer() {
+    if (phaseMs != nullptr) {
+        *phaseMs += std::chrono::duration<double, std::milli>(
+                        std::chrono::steady_clock::now() - start).count();
+    }
+} // ~PhaseTimer()
+
+DictScanner::DictScanner(std::string_view dictText) : text(dictText) {
+} // DictScanner()
+
+void DictScanner::skipSpace() {
+    while (pos < text.size() && 
+           (text[pos] == ' ' || (text[pos] >= '\t' && text[pos] <= '\r'))) {
+        pos++;
+    }
+} // skipSpace()
+
+char DictScanner::nextChar() {
+    skipSpace();
+    return pos < text.size() ? text[pos++] : '\0';
+} // nextChar()
+
+size_t DictScanner::nextNumber() {
+    skipSpace();
+    size_t number = 0;
+    while (pos < text.size() && text[pos] >= '0' && text[pos] <= '9') {
+        number = number * 10 + static_cast<size_t>(text[pos++] - '0');
+    }
+    return number;
+} // nextNumber()
+
+bool DictScanner::nextToken(std::string_view &token) {
+    skipSpace();
+    size_t tokenStart = pos;
+    while (pos < text.size() && 
+           !(text[pos] == ' ' || (text[pos] >= '\t' && text[pos] <= '\r'))) {
+        pos++;
+    }
+    token = text.substr(tokenStart, pos - tokenStart);
+    return !token.empty();
+} // nextToken()
+
+void DictScanner::skipLine() {
+    // like getline(), the newline itself is consumed too
+    size_t lineEnd = text.find('\n', pos);
+    pos = lineEnd == std::string_view::npos ? text.size() : lineEnd + 1;
+} // skipLine()
 
 void LetterManClass::getOptions(int argc, char** argv) {
     int option_index = 0, option = 0;
@@ -97,10 +707,23 @@ void LetterManClass::getOptions(int argc, char** argv) {
                                 { "change", no_argument, nullptr, 'c'},
                                 { "length", no_argument, nullptr, 'l'},
                                 { "swap", no_argument, nullptr, 'p'},
+                                { "neighbors", required_argument, nullptr, 'n'},
+                                { "build-cache", required_argument, nullptr, 'B'},
+                                { "cache", required_argument, nullptr, 'C'},
+                                { "requests", required_argument, nullptr, 'r'},
+                                { "bidirectional", no_argument, nullptr, 'd'},
+                                { "threads", required_argument, nullptr, 't'},
+                                { "dedup", no_argument, nullptr, 'u'},
+                                { "stats", no_argument, nullptr, 'S'},
+                                { "astar", no_argument, nullptr, 'a'},
+                                { "hybrid", no_argument, nullptr, 'H'},
+                                { "all-shortest", no_argument, nullptr, 'A'},
+                                { "limit", required_argument, nullptr, 'L'},
+                                { "tree-cache", required_argument, nullptr, 'T'},
                                 { "help", no_argument, nullptr, 'h' },
                                 { nullptr, 0, nullptr, '\0' }};
     
-    while ((option = getopt_long(argc, argv, "qsb:e:o:clph", 
+    while ((option = getopt_long(argc, argv, "qsb:e:o:clpn:B:C:r:dt:uSaHAL:T:h", 
                                  longOpts, &option_index)) != -1) {
         switch (option) {
             case 'q':
@@ -137,12 +760,104 @@ void LetterManClass::getOptions(int argc, char** argv) {
             case 'p':
                 swapIsSpecified = true;
                 break;
+
+            case 'n':
+                neighborEngine = optarg;
+                break;
+
+            case 'B':
+                buildCacheFile = optarg;
+                break;
+
+            case 'C':
+                cacheFile = optarg;
+                break;
+
+            case 'r':
+                requestFile = optarg;
+                break;
+
+            case 'd':
+                bidirectionalIsSpecified = true;
+                break;
+
+            case 'u':
+                dedupIsSpecified = true;
+                break;
+
+            case 'S':
+                stats.reset(new RunStats);
+                break;
+
+            case 'a':
+                astarIsSpecified = true;
+                break;
+
+            case 'H':
+                hybridIsSpecified = true;
+                break;
+
+            case 'A':
+                allShortestIsSpecified = true;
+                break;
+
+            case 'L':
+                if (std::string(optarg).find_first_not_of("0123456789") != 
+                    std::string::npos || std::string(optarg).empty()) {
+                    std::cerr << "Invalid limit specified, limit: " << optarg << "\n";
+                    exit(1);
+                }
+                morphLimit = static_cast<size_t>(std::strtoull(optarg, nullptr, 10));
+                limitIsSpecified = true;
+                break;
+
+            case 'T': {
+                errno = 0;
+                unsigned long long treeCacheArg = std::strtoull(optarg, nullptr, 10);
+                // megabytes are shifted into bytes, so larger values would wrap
+                if (std::string(optarg).find_first_not_of("0123456789") != 
+                    std::string::npos || std::string(optarg).empty() || 
+                    errno == ERANGE || treeCacheArg > (SIZE_MAX >> 20)) {
+                    std::cerr << "Invalid tree cache size specified, tree-cache: " << optarg << "\n";
+                    exit(1);
+                }
+                treeCacheBytes = static_cast<size_t>(treeCacheArg) << 20;
+                break;
+            }
+
+            case 't': {
+                errno = 0;
+                unsigned long threadArg = std::strtoul(optarg, nullptr, 10);
+                if (std::string(optarg).find_first_not_of("0123456789") != 
+                    std::string::npos || std::string(optarg).empty() || 
+                    errno == ERANGE || threadArg < 1) {
+                    std::cerr << "Invalid number of threads specified, threads: " << optarg << "\n";
+                    exit(1);
+                }
+                // past a few threads per core the pool only adds contention
+                size_t maxThreads = 4 * std::max(1u, std::thread::hardware_concurrency());
+                if (threadArg > maxThreads) {
+                    std::cerr << "Too many threads specified, threads: " << optarg 
+                              << ", at most " << maxThreads << "\n";
+                    exit(1);
+                }
+                numThreads = static_cast<size_t>(threadArg);
+                break;
+            }
             
             case 'h':
                 std::cout << "This program reads a txt file that contains a dictionary,\n"
                           << "It then outputs the path from begin word to end word\n"
                           << "specified in the command line argumentsfollowing the\n"
                           << "rules specified in command line arguments.\n"
+                          << "With --requests, begin and end words are read from the\n"
+                          << "request file instead, one \'begin end... [-s | -q]\' per line.\n"
+                          << "Searches from a begin word are kept and resumed for later\n"
+                          << "end words, within the --tree-cache budget (64 MB default).\n"
+                          << "With --threads, queue requests are searched from scratch\n"
+                          << "on the thread pool instead.\n"
+                          << "A line \'+ word...\' or \'- word...\' adds or removes words\n"
+                          << "for the requests after it.\n"
                           << "Usage: \'./project1\n\t[--queue | -q]\n"
                           <<                      "\t[--stack | -s]\n"
                           <<                      "\t[--begin | -b] <begin word>\n"
@@ -151,6 +866,19 @@ void LetterManClass::getOptions(int argc, char** argv) {
                           <<                      "\t[--change | -c]\n"
                           <<                      "\t[--length | -l]\n"
                           <<                      "\t[--swap | -p]\n"
+                          <<                      "\t[--neighbors | -n] <index | scan | probe>\n"
+                          <<                      "\t[--build-cache | -B] <cache file>\n"
+                          <<                      "\t[--cache | -C] <cache file>\n"
+                          <<                      "\t[--requests | -r] <request file>\n"
+                          <<                      "\t[--bidirectional | -d]\n"
+                          <<                      "\t[--threads | -t] <number of threads>\n"
+                          <<                      "\t[--dedup | -u]\n"
+                          <<                      "\t[--stats | -S]\n"
+                          <<                      "\t[--astar | -a]\n"
+                          <<                      "\t[--hybrid | -H]\n"
+                          <<                      "\t[--all-shortest | -A]\n"
+                          <<                      "\t[--limit | -L] <number of morphs>\n"
+                          <<                      "\t[--tree-cache | -T] <megabytes>\n"
                           <<                      "\t[--help | -h]\n"
                           <<                      "\t< <TXT dictionary file>\'" << std::endl;    
                 exit(0);
@@ -161,6 +889,14 @@ void LetterManClass::getOptions(int argc, char** argv) {
         outputFormat = "W";
     }
 
+    if (numThreads > 1) {
+        threadPool.reset(new ThreadPool(numThreads));
+    }
+
+    if (neighborEngine.empty()) {
+        neighborEngine = "index";
+    }
+
     if (stackIsSpecified && queueIsSpecified) {
         std::cerr << "Conflicting or duplicate stack and queue specified\n";
         exit(1);
@@ -171,18 +907,89 @@ void LetterManClass::getOptions(int argc, char** argv) {
         exit(1);
     }
 
+    if (bidirectionalIsSpecified && stackIsSpecified) {
+        std::cerr << "Bidirectional search requires queue mode\n";
+        exit(1);
+    }
+
+    if (astarIsSpecified && stackIsSpecified) {
+        std::cerr << "A* search requires queue mode\n";
+        exit(1);
+    }
+
+    if (astarIsSpecified && bidirectionalIsSpecified) {
+        std::cerr << "Conflicting A* and bidirectional search specified\n";
+        exit(1);
+    }
+
+    if (hybridIsSpecified && stackIsSpecified) {
+        std::cerr << "Hybrid search requires queue mode\n";
+        exit(1);
+    }
+
+    if (hybridIsSpecified && (astarIsSpecified || bidirectionalIsSpecified)) {
+        std::cerr << "Conflicting hybrid and A* or bidirectional search specified\n";
+        exit(1);
+    }
+
+    if (allShortestIsSpecified && stackIsSpecified) {
+        std::cerr << "All shortest morphs require queue mode\n";
+        exit(1);
+    }
+
+    if (allShortestIsSpecified && 
+        (astarIsSpecified || bidirectionalIsSpecified || hybridIsSpecified)) {
+        std::cerr << "Conflicting all-shortest and A*, bidirectional "
+                  << "or hybrid search specified\n";
+        exit(1);
+    }
+
+    if (limitIsSpecified && !allShortestIsSpecified) {
+        std::cerr << "Limit requires all-shortest\n";
+        exit(1);
+    }
+
     if (!(changeIsSpecified || lengthIsSpecified || swapIsSpecified)) {
         std::cerr << "Must specify at least one" 
                   << "modification mode (change length swap)\n";
         exit(1);
     }
 
-    if (!beginIsSpecified || beginWord.empty()) {
+    switch (modeFlags() & (changeBit | swapBit | lengthBit)) {
+        case changeBit:
+            selectModeSet<changeBit>();
+            break;
+        case swapBit:
+            selectModeSet<swapBit>();
+            break;
+        case lengthBit:
+            selectModeSet<lengthBit>();
+            break;
+        case changeBit | swapBit:
+            selectModeSet<changeBit | swapBit>();
+            break;
+        case changeBit | lengthBit:
+            selectModeSet<changeBit | lengthBit>();
+            break;
+        case swapBit | lengthBit:
+            selectModeSet<swapBit | lengthBit>();
+            break;
+        default:
+            selectModeSet<changeBit | swapBit | lengthBit>();
+            break;
+    } // one instantiation per valid mode set
+
+    if (!requestFile.empty() && (beginIsSpecified || endIsSpecified)) {
+        std::cerr << "Begin and end words come from the request file\n";
+        exit(1);
+    }
+
+    if (requestFile.empty() && (!beginIsSpecified || beginWord.empty())) {
         std::cerr << "Beginning word not specified\n";
         exit(1);
     }
 
-    if (!endIsSpecified || endWord.empty()) {
+    if (requestFile.empty() && (!endIsSpecified || endWord.empty())) {
         std::cerr << "Ending word not specified\n";
         exit(1);
     }
@@ -198,15 +1005,28 @@ void LetterManClass::getOptions(int argc, char** argv) {
         exit(1);
     }
 
+    if (neighborEngine != "index" && neighborEngine != "scan" && neighborEngine != "probe") {
+        std::cerr << "Invalid neighbor engine specified, neighbors: " << neighborEngine << "\n";
+        exit(1);
+    }
+
+    if (!buildCacheFile.empty() && !cacheFile.empty()) {
+        std::cerr << "Conflicting build-cache and cache specified\n";
+        exit(1);
+    }
+
+    sortedBegin = beginWord;
+    sortedEnd = endWord;
+    std::sort(sortedBegin.begin(), sortedBegin.end());
+    std::sort(sortedEnd.begin(), sortedEnd.end());
+
 } // getOptions()
 
-bool LetterManClass::wordShouldInDict(std::string &newWord) {
-    std::string tempWord1 = beginWord;
-    std::string tempWord2 = endWord;
-    std::string tempWord3 = newWord;
-    std::sort(tempWord1.begin(), tempWord1.end());
-    std::sort(tempWord2.begin(), tempWord2.end());
-    std::sort(tempWord3.begin(), tempWord3.end());
+bool LetterManClass::wordShouldInDict(std::string_view newWord, std::string &sortedLetters) {
+    if (!requestFile.empty() || !buildCacheFile.empty()) {
+        return true;
+    } // every request has its own begin and end word, and a cache serves 
+      // any begin and end word, keep all words
 
     if (newWord == beginWord || newWord == endWord) {
         return true;
@@ -218,11 +1038,14 @@ bool LetterManClass::wordShouldInDict(std::string &newWord) {
             }
             else {
                 if (!changeIsSpecified) {
-                    if (tempWord1 != tempWord2) {
+                    if (sortedBegin != sortedEnd) {
                         return false;
                     }
                     else {
-                        return tempWord3 == tempWord1;
+                        // only this case needs the letters of newWord sorted
+                        sortedLetters.assign(newWord);
+                        std::sort(sortedLetters.begin(), sortedLetters.end());
+                        return sortedLetters == sortedBegin;
                     }
                 }
             }
@@ -232,7 +1055,7 @@ bool LetterManClass::wordShouldInDict(std::string &newWord) {
     return true;
 } // wordShouldInDict(string newWord)
 
-void LetterManClass::checkBeginEnd(std::string &wordToPush, int &numWordsInDict) {
+void LetterManClass::checkBeginEnd(std::string_view wordToPush, int &numWordsInDict) {
     if (wordToPush == beginWord) {
         beginWordFound = true;
         beginWordIdx = numWordsInDict;
@@ -243,213 +1066,917 @@ void LetterManClass::checkBeginEnd(std::string &wordToPush, int &numWordsInDict)
     }
 } // checkBeginEnd(string, int)
 
+size_t LetterManClass::numWords() {
+    return wordLengths.size();
+} // numWords()
+
+std::string_view LetterManClass::wordAt(size_t wordIdx) {
+    return std::string_view(wordLetters.data() + wordOffsets[wordIdx], wordLengths[wordIdx]);
+} // wordAt()
+
+void LetterManClass::addWord(std::string_view newWord) {
+    wordOffsets.push_back(static_cast<uint32_t>(wordLetters.size()));
+    wordLengths.push_back(static_cast<uint32_t>(newWord.size()));
+    wordLetters.insert(wordLetters.end(), newWord.begin(), newWord.end());
+} // addWord()
+
+void LetterManClass::removeLastWord() {
+    wordLetters.resize(wordOffsets.back());
+    wordOffsets.pop_back();
+    wordLengths.pop_back();
+} // removeLastWord()
+
+void LetterManClass::pushWord(std::string_view newWord, int &numWordsInDict) {
+    if (stats) {
+        stats->wordsRead++;
+    }
+
+    bool keepWord;
+    {
+        PhaseTimer timer(stats ? &stats->filterMs : nullptr);
+        keepWord = wordShouldInDict(newWord, sortedWord);
+    }
+    if (!keepWord) {
+        if (stats) {
+            stats->wordsFiltered++;
+        }
+        return;
+    }
+
+    commitWord(newWord, numWordsInDict);
+} // pushWord()
+
+void LetterManClass::commitWord(std::string_view newWord, int &numWordsInDict) {
+    addWord(newWord);
+    if (dedupIsSpecified && 
+        !uniqueWords.insert(static_cast<uint32_t>(numWordsInDict)).second) {
+        removeLastWord();
+        numDuplicates++;
+        return;
+    } // if an equal word is already in the dictionary
+
+    // begin and end words always pass wordShouldInDict()
+    checkBeginEnd(newWord, numWordsInDict);
+    numWordsInDict++;
+} // commitWord()
+
+LetterManClass::~LetterManClass() {
+    if (cacheData != nullptr) {
+        munmap(const_cast<char *>(cacheData), cacheSize);
+    }
+    if (dictMapped != nullptr) {
+        munmap(const_cast<char *>(dictMapped), dictMappedSize);
+    }
+} // ~LetterManClass()
+
+bool LetterManClass::cacheIsSpecified() {
+    return !cacheFile.empty();
+} // cacheIsSpecified()
+
+bool LetterManClass::requestsAreSpecified() {
+    return !requestFile.empty();
+} // requestsAreSpecified()
+
+uint64_t LetterManClass::hashBytes(const char *bytes, size_t numBytes, 
+                                   uint64_t hash) {
+    // FNV-1a, chained through hash so the input can arrive in blocks
+    for (size_t i = 0; i < numBytes; i++) {
+        hash ^= static_cast<unsigned char>(bytes[i]);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+} // hashBytes()
+
+uint32_t LetterManClass::modeFlags() {
+    // --dedup is not a mode, but it changes which words are cached
+    return (changeIsSpecified ? uint32_t(changeBit) : 0u) | 
+           (swapIsSpecified ? uint32_t(swapBit) : 0u) | 
+           (lengthIsSpecified ? uint32_t(lengthBit) : 0u) | 
+           (dedupIsSpecified ? 8u : 0u);
+} // modeFlags()
+
+void LetterManClass::loadDictText() {
+    struct stat dictStat;
+    off_t dictStart = lseek(STDIN_FILENO, 0, SEEK_CUR);
+    if (fstat(STDIN_FILENO, &dictStat) == 0 && S_ISREG(dictStat.st_mode) && 
+        dictStart >= 0 && dictStat.st_size > dictStart) {
+        dictMappedSize = static_cast<size_t>(dictStat.st_size);
+        void *mapped = mmap(nullptr, dictMappedSize, PROT_READ, MAP_PRIVATE, 
+                            STDIN_FILENO, 0);
+        if (mapped != MAP_FAILED) {
+            madvise(mapped, dictMappedSize, MADV_SEQUENTIAL);
+            dictMapped = static_cast<const char *>(mapped);
+            dictText = std::string_view(dictMapped + dictStart, 
+                                        dictMappedSize - static_cast<size_t>(dictStart));
+            return;
+        }
+    } // if stdin is a regular file, map it
+
+    // pipes and terminals are read in large blocks instead
+    size_t numBytes = 0;
+    ssize_t numRead;
+    dictBuffer.resize(1 << 20);
+    while ((numRead = read(STDIN_FILENO, &dictBuffer[numBytes], 
+                           dictBuffer.size() - numBytes)) > 0) {
+        numBytes += static_cast<size_t>(numRead);
+        if (numBytes == dictBuffer.size()) {
+            dictBuffer.resize(dictBuffer.size() * 2);
+        }
+    } // while stdin has more
+    dictBuffer.resize(numBytes);
+    dictText = dictBuffer;
+} // loadDictText()
+
 void LetterManClass::readDict() {
-    char dictType;
-    size_t numLines;
-    std::cin >> dictType >> numLines;
+    PhaseTimer timer(stats ? &stats->readMs : nullptr);
+    loadDictText();
+
+    // a cache is tied to the raw dictionary text, so hash it before parsing
+    if (!buildCacheFile.empty()) {
+        dictHash = hashBytes(dictText.data(), dictText.size(), hashSeed);
+    }
+
+    parseDict(dictText);
+} // readDict()
+
+void LetterManClass::parseDict(std::string_view text) {
+    DictScanner scanner(text);
+
+    char dictType = scanner.nextChar();
+    size_t numLines = scanner.nextNumber();
 
     int numWordsInDict = 0;
 
-    if (dictType == 'S') {
-        dictionary.reserve(numLines);
+    // a handful of allocations up front instead of one per word, a simple 
+    // dictionary never has more letters than the text holds
+    wordOffsets.reserve(numLines);
+    wordLengths.reserve(numLines);
+    wordLetters.reserve(text.size());
+
+    if (dedupIsSpecified) {
+        uniqueWords = std::unordered_set<uint32_t, WordIdxHash, WordIdxEqual>(
+            numLines * 2, WordIdxHash{this}, WordIdxEqual{this});
+    }
+
+    if (threadPool) {
+        pipelineDict(scanner, dictType, numLines, numWordsInDict);
+    } // a parser thread feeds the pool, which filters and indexes
+    else {
+        scanDictWords(scanner, dictType, numLines, [&](std::string_view word) {
+            pushWord(word, numWordsInDict);
+        });
+    }
 
-        std::cin.ignore();
+    if (dedupIsSpecified) {
+        std::cerr << "Removed " << numDuplicates << " duplicate words.\n";
+    }
+} // parseDict()
 
-        Word newLine;
+template <typename WordSink>
+void LetterManClass::scanDictWords(DictScanner &scanner, char dictType, size_t numLines, 
+                                   WordSink &&pushToken) {
+    std::string_view token;
 
+    if (dictType == 'S') {
         for (size_t i = 0; i < numLines; i++) {
-            std::cin >> newLine.word;
+            if (!scanner.nextToken(token)) {
+                break;
+            } // fewer words than promised
 
-            if (newLine.word.substr(0,2) == "//") {
-                getline(std::cin, newLine.word);
+            if (token.substr(0,2) == "//") {
+                scanner.skipLine();
                 i--;
             }
 
             else {
-                checkBeginEnd(newLine.word, numWordsInDict);
-                if (wordShouldInDict(newLine.word)) {
-                    
-                    dictionary.emplace_back(newLine);
-                    numWordsInDict++;
-                } // if newline word should be in dict
+                pushToken(token);
             } // new input line actually contains a word
         } // for (i)
     } // if dictType == 'S'
 
     else {
-        // dictionary.reserve(numLines * 2);
-
-        std::cin.ignore();
-
-        Word newLine;
-
-        std::string temp;
+        // every variant is built in this one buffer, then copied to the arena
+        std::string variant;
+        variant.reserve(64);
 
         const char signReversal = '&';
         const char signInsert = '[';
         const char signInsertEnd = ']';
         const char signSwap = '!';
         const char signDouble = '?';
-        const std::string specialSign = "&[]!?";
+        const std::string_view specialSign = "&[]!?";
 
         for (size_t i = 0; i < numLines; i++) {
-            std::cin >> temp;
+            if (!scanner.nextToken(token)) {
+                break;
+            } // fewer lines than promised
 
-            if (temp.substr(0,2) == "//") {
-                getline(std::cin, temp);
+            if (token.substr(0,2) == "//") {
+                scanner.skipLine();
                 i--;
+                continue;
             }
 
-            else {
-                size_t specialSignIdx = temp.find_first_of(specialSign);
-                size_t insertSignEndIdx = temp.find_first_of(signInsertEnd);
-                
-                if (specialSignIdx == std::string::npos) {
-                    checkBeginEnd(temp, numWordsInDict);
-                    if (wordShouldInDict(temp)) {
-                        
-                        newLine.word = temp;
-                        dictionary.emplace_back(newLine);
-                        numWordsInDict++;
-                    } // if newline word should be in dict
-                } // if no special character is found in this line
+            size_t specialSignIdx = token.find_first_of(specialSign);
+            if (specialSignIdx == std::string_view::npos) {
+                pushToken(token);
+                continue;
+            } // if no special character is found in this line
 
-                else {
-                    if (temp[specialSignIdx] == signReversal) {
-                        //push the original word
-                        temp = temp.substr(0, specialSignIdx);
-                        checkBeginEnd(temp, numWordsInDict);
-                        if (wordShouldInDict(temp)) {
-                            
-                            newLine.word = temp;
-                            dictionary.emplace_back(newLine);
-                            numWordsInDict++;
-                        } // if newline word should be in dict
-
-                        //push the reversed word
-                        std::reverse(temp.begin(), temp.end());
-                        checkBeginEnd(temp, numWordsInDict);
-                        if (wordShouldInDict(temp)) {
-                            
-                            newLine.word = temp;
-                            dictionary.emplace_back(newLine);
-                            numWordsInDict++;
-                        } // if reversed newline word should be in dict
-                    } // if reversal
-                    
-
-                    if (temp[specialSignIdx] == signInsert) {
-                        std::string temp1 = temp;
-                        
-                        for (size_t j = specialSignIdx + 1; 
-                                j < insertSignEndIdx; j++) {
-                            
-                            temp = 
-                                temp1.substr(0, specialSignIdx) + 
-                                temp1[j] + 
-                                temp1.substr(insertSignEndIdx + 1, 
-                                temp1.size() - insertSignEndIdx - 1);
-                            checkBeginEnd(temp, numWordsInDict);
-                            if (wordShouldInDict(temp)) {
-                                
-                                newLine.word = temp;
-                                dictionary.emplace_back(newLine);
-                                numWordsInDict++;
-                            } // if inserted newline word should be in dict
-                        } // for (j)
-                    } // if insert
-                    
-
-                    if (temp[specialSignIdx] == signSwap) {
-                        temp = temp.substr(0, specialSignIdx) + 
-                                temp.substr(specialSignIdx + 1, 
-                                temp.size() - specialSignIdx - 1);
-                        checkBeginEnd(temp, numWordsInDict);
-                        if (wordShouldInDict(temp)) {
-                            
-                            newLine.word = temp;
-                            dictionary.emplace_back(newLine);
-                            numWordsInDict++;
-                        } // if reversed newline word should be in dict
-                        std::string temp1 = temp;
-                        temp[specialSignIdx - 1] = temp1[specialSignIdx - 2];
-                        temp[specialSignIdx - 2] = temp1[specialSignIdx - 1];
-                        checkBeginEnd(temp, numWordsInDict);
-                        if (wordShouldInDict(temp)) {
-                            
-                            newLine.word = temp;
-                            dictionary.emplace_back(newLine);
-                            numWordsInDict++;
-                        } // if swapped newline word should be in dict
-                    } // if swap
-                    
-
-                    if (temp[specialSignIdx] == signDouble) {
-                        std::string temp1 = temp.substr(0, specialSignIdx) + 
-                                temp.substr(specialSignIdx + 1, 
-                                temp.size() - specialSignIdx - 1);
-                        checkBeginEnd(temp1, numWordsInDict);
-                        if (wordShouldInDict(temp1)) {
-                            
-                            newLine.word = temp1;
-                            dictionary.emplace_back(newLine);
-                            numWordsInDict++;
-                        } // if non-doubled newline word should be in dict
-                        std::string temp2 = temp.substr(0, specialSignIdx) + 
-                                       temp[specialSignIdx - 1] + 
-                                       temp.substr(specialSignIdx + 1, 
-                                       temp.size() - specialSignIdx - 1);
-                        checkBeginEnd(temp2, numWordsInDict);
-                        if (wordShouldInDict(temp2)) {
-                            
-                            newLine.word = temp2;
-                            dictionary.emplace_back(newLine);
-                            numWordsInDict++;
-                        } // if reversed newline word should be in dict
-                    } // if double
-                } // special character processing
-            } // new input line actually contains one or two words
+            std::string_view prefix = token.substr(0, specialSignIdx);
+
+            switch (token[specialSignIdx]) {
+                case signReversal:
+                    //push the original word, then the reversed word
+                    pushToken(prefix);
+                    variant.assign(prefix.rbegin(), prefix.rend());
+                    pushToken(variant);
+                    break;
+
+                case signInsert: {
+                    size_t insertSignEndIdx = token.find(signInsertEnd);
+                    std::string_view suffix = token.substr(insertSignEndIdx + 1);
+                    for (size_t j = specialSignIdx + 1; j < insertSignEndIdx; j++) {
+                        variant.assign(prefix);
+                        variant += token[j];
+                        variant.append(suffix);
+                        pushToken(variant);
+                    } // for (j)
+                    break;
+                }
+
+                case signSwap:
+                    //push the word without the sign, then with the two 
+                    //letters before the sign swapped
+                    variant.assign(prefix);
+                    variant.append(token.substr(specialSignIdx + 1));
+                    pushToken(variant);
+                    std::swap(variant[specialSignIdx - 2], variant[specialSignIdx - 1]);
+                    pushToken(variant);
+                    break;
+
+                case signDouble:
+                    //push the word without the sign, then with the letter 
+                    //before the sign doubled
+                    variant.assign(prefix);
+                    variant.append(token.substr(specialSignIdx + 1));
+                    pushToken(variant);
+                    variant.insert(specialSignIdx, 1, token[specialSignIdx - 1]);
+                    pushToken(variant);
+                    break;
+            } // special character processing
         } // for(i)
     } // dictType == 'C'
-} // readDict()
+} // scanDictWords()
 
-bool LetterManClass::areSimilarWords(Word &investingWord, 
-                                     Word &currentWord) {
-    
-    size_t invstWordSize = investingWord.word.size();
-    size_t crntWordSize = currentWord.word.size();
+void LetterManClass::pipelineDict(DictScanner &scanner, char dictType, size_t numLines, 
+                                  int &numWordsInDict) {
+    const size_t wordsPerChunk = 4096;
+    // the parser stays at most this many chunks ahead of the commits
+    const size_t maxChunksAhead = 4 * threadPool->size();
 
-    if ((invstWordSize > crntWordSize && invstWordSize - crntWordSize > 1) || 
-        (crntWordSize > invstWordSize && crntWordSize - invstWordSize > 1)) {
-        return false;
-    } // if diff of size > 1, not similar
-    
-    else if (invstWordSize == crntWordSize) {
-        if (!(changeIsSpecified || swapIsSpecified)) {
-            return false;
+    if (neighborEngine == "index") {
+        changeBuckets.reserve(changeIsSpecified ? numLines * 4 : 0);
+        swapBuckets.reserve(swapIsSpecified ? numLines * 4 : 0);
+        wordBuckets.reserve(lengthIsSpecified ? numLines : 0);
+        deletionBuckets.reserve(lengthIsSpecified ? numLines * 4 : 0);
+    } // the index is filled chunk by chunk as the words are committed
+
+    std::mutex chunkMutex;
+    std::condition_variable chunkReady;
+    std::condition_variable chunkCommitted;
+    std::vector<std::unique_ptr<DictChunk>> chunks;
+    size_t numProduced = 0;
+    size_t numCommitted = 0;
+    bool parsingDone = false;
+
+    // one thread tokenizes and expands, the pool does everything after that
+    std::thread parser([&] {
+        std::unique_ptr<DictChunk> chunk(new DictChunk);
+        auto handOver = [&] {
+            std::unique_lock<std::mutex> chunkLock(chunkMutex);
+            chunkCommitted.wait(chunkLock, [&] { 
+                return numProduced - numCommitted < maxChunksAhead; 
+            });
+            chunks.push_back(std::move(chunk));
+            numProduced++;
+            chunkReady.notify_all();
+            chunk.reset(new DictChunk);
+        };
+
+        scanDictWords(scanner, dictType, numLines, [&](std::string_view word) {
+            chunk->letters.append(word);
+            chunk->lengths.push_back(static_cast<uint32_t>(word.size()));
+            if (chunk->lengths.size() == wordsPerChunk) {
+                handOver();
+            }
+        });
+        if (!chunk->lengths.empty()) {
+            handOver();
         }
 
-        else if (changeIsSpecified && swapIsSpecified) {
-            int numDiffLetter = 0;
-            bool isSwapped = false;
+        std::lock_guard<std::mutex> chunkGuard(chunkMutex);
+        parsingDone = true;
+        chunkReady.notify_all();
+    });
 
-            for (size_t i = 0; i < invstWordSize; i++) {
-                if (investingWord.word[i] != currentWord.word[i]) {
-                    numDiffLetter++;
-                    if (i < invstWordSize - 1 && 
-                        investingWord.word[i] == currentWord.word[i + 1] &&
-                        investingWord.word[i + 1] == currentWord.word[i]) {
-                        isSwapped = true;
+    std::atomic<size_t> nextChunk{0};
+    threadPool->run(threadPool->size(), [&](size_t) {
+        std::string sortedLetters;
+        for (size_t chunkIdx = nextChunk++; ; chunkIdx = nextChunk++) {
+            DictChunk *chunk;
+            {
+                std::unique_lock<std::mutex> chunkLock(chunkMutex);
+                chunkReady.wait(chunkLock, [&] { 
+                    return chunkIdx < numProduced || parsingDone; 
+                });
+                if (chunkIdx >= numProduced) {
+                    return;
+                } // every chunk is taken
+                chunk = chunks[chunkIdx].get();
+            }
+
+            chunk->keep.resize(chunk->lengths.size());
+            size_t letterIdx = 0;
+            size_t numFiltered = 0;
+            double filterMs = 0;
+            {
+                PhaseTimer timer(stats ? &filterMs : nullptr);
+                for (size_t i = 0; i < chunk->lengths.size(); i++) {
+                    std::string_view word(chunk->letters.data() + letterIdx, chunk->lengths[i]);
+                    chunk->keep[i] = wordShouldInDict(word, sortedLetters);
+                    numFiltered += !chunk->keep[i];
+                    letterIdx += chunk->lengths[i];
+                } // for (i)
+            }
+            if (stats) {
+                stats->wordsRead += chunk->lengths.size();
+                stats->wordsFiltered += numFiltered;
+            }
+
+            // chunks are committed in the order they were parsed, so every 
+            // word gets the index a single thread would have given it
+            {
+                std::unique_lock<std::mutex> chunkLock(chunkMutex);
+                if (stats) {
+                    stats->filterMs += filterMs;
+                } // filterMs is shared, the lock is taken here anyway
+                chunkCommitted.wait(chunkLock, [&] { 
+                    return numCommitted == chunkIdx; 
+                });
+            }
+            commitChunk(*chunk, numWordsInDict);
+
+            std::lock_guard<std::mutex> chunkGuard(chunkMutex);
+            chunks[chunkIdx].reset();
+            numCommitted++;
+            chunkCommitted.notify_all();
+        } // for (chunkIdx)
+    });
+
+    parser.join();
+} // pipelineDict()
+
+void LetterManClass::commitChunk(DictChunk &chunk, int &numWordsInDict) {
+    size_t firstNewWord = numWords();
+    size_t letterIdx = 0;
+    for (size_t i = 0; i < chunk.lengths.size(); i++) {
+        if (chunk.keep[i]) {
+            commitWord(std::string_view(chunk.letters.data() + letterIdx, chunk.lengths[i]), 
+                       numWordsInDict);
+        }
+        letterIdx += chunk.lengths[i];
+    } // for (i)
+
+    if (neighborEngine != "index") {
+        return;
+    } // the scan and the probe table need the whole dictionary first
+
+    // one mode at a time, as in buildNeighborIndex()
+    for (ModificationMode mode : {changeMode, swapMode, lengthMode}) {
+        if ((mode == changeMode && !changeIsSpecified) || 
+            (mode == swapMode && !swapIsSpecified) || 
+            (mode == lengthMode && !lengthIsSpecified)) {
+            continue;
+        }
+        for (size_t i = firstNewWord; i < numWords(); i++) {
+            bucketWord(i, mode, true);
+        }
+    } // for (mode)
+    numBucketedWords = numWords();
+} // commitChunk()
+
+void LetterManClass::loadCache() {
+    PhaseTimer timer(stats ? &stats->readMs : nullptr);
+    int cacheFd = open(cacheFile.c_str(), O_RDONLY);
+    struct stat cacheStat;
+    if (cacheFd < 0 || fstat(cacheFd, &cacheStat) != 0) {
+        std::cerr << "Cache file could not be opened: " << cacheFile << "\n";
+        exit(1);
+    }
+
+    cacheSize = static_cast<size_t>(cacheStat.st_size);
+    if (cacheSize < sizeof(CacheHeader)) {
+        std::cerr << "Cache file is corrupt: " << cacheFile << "\n";
+        exit(1);
+    }
+
+    void *mapped = mmap(nullptr, cacheSize, PROT_READ, MAP_PRIVATE, cacheFd, 0);
+    close(cacheFd);
+    if (mapped == MAP_FAILED) {
+        std::cerr << "Cache file could not be mapped: " << cacheFile << "\n";
+        exit(1);
+    }
+    cacheData = static_cast<const char *>(mapped);
+
+    CacheHeader header;
+    std::memcpy(&header, cacheData, sizeof(header));
+    if (std::memcmp(header.magic, cacheMagic, sizeof(cacheMagic)) != 0 || 
+        header.version != cacheVersion) {
+        std::cerr << "Cache file has an unsupported format: " << cacheFile << "\n";
+        exit(1);
+    }
+
+    // bounded first, so the size below cannot wrap around
+    if (header.numWords >= INT_MAX || header.numWords > cacheSize / sizeof(uint32_t) || 
+        header.numEdges > cacheSize / sizeof(uint32_t) || header.wordBytes > cacheSize) {
+        std::cerr << "Cache file is corrupt: " << cacheFile << "\n";
+        exit(1);
+    }
+
+    auto padded = [](uint64_t numBytes) { return (numBytes + 7) & ~uint64_t(7); };
+    uint64_t offsetsBytes = padded((header.numWords + 1) * sizeof(uint32_t));
+    uint64_t expectedSize = sizeof(CacheHeader) + offsetsBytes + padded(header.wordBytes) + 
+                            offsetsBytes + header.numEdges * sizeof(uint32_t);
+    if (expectedSize != cacheSize) {
+        std::cerr << "Cache file is corrupt: " << cacheFile << "\n";
+        exit(1);
+    }
+
+    if (header.modeFlags != modeFlags()) {
+        std::cerr << "Cache was built for different modification modes\n";
+        exit(1);
+    }
+
+    // the cache holds every word, output() and answerRequest() apply 
+    // the length and letter filters of wordShouldInDict() per query
+    const char *section = cacheData + sizeof(CacheHeader);
+    const uint32_t *cachedOffsets = reinterpret_cast<const uint32_t *>(section);
+    section += offsetsBytes;
+    const char *wordBytes = section;
+    section += padded(header.wordBytes);
+    graphOffsets = reinterpret_cast<const uint32_t *>(section);
+    section += offsetsBytes;
+    graphTargets = reinterpret_cast<const uint32_t *>(section);
+
+    // a damaged file of the right size would send wordAt() and 
+    // findNeighbors() out of bounds, so check every offset and target once
+    auto offsetsEndAt = [&](const uint32_t *offsets, uint64_t end) {
+        for (size_t i = 0; i < header.numWords; i++) {
+            if (offsets[i] > offsets[i + 1]) {
+                return false;
+            }
+        } // for (i)
+        return offsets[0] == 0 && offsets[header.numWords] == end;
+    };
+    bool cacheIsValid = offsetsEndAt(cachedOffsets, header.wordBytes) && 
+                        offsetsEndAt(graphOffsets, header.numEdges);
+    for (size_t i = 0; cacheIsValid && i < header.numEdges; i++) {
+        cacheIsValid = graphTargets[i] < header.numWords;
+    } // for (i)
+    if (!cacheIsValid) {
+        std::cerr << "Cache file is corrupt: " << cacheFile << "\n";
+        exit(1);
+    }
+
+    // the dictionary is still read to prove the cache is not stale, 
+    // but hashing it is far cheaper than parsing and comparing words
+    loadDictText();
+    if (hashBytes(dictText.data(), dictText.size(), hashSeed) != header.dictHash) {
+        std::cerr << "Cache does not match the dictionary, rebuild it\n";
+        exit(1);
+    }
+
+    // the letters are copied out, request updates append to them, only 
+    // the adjacency is used in place from the mapping
+    wordLetters.assign(wordBytes, wordBytes + header.wordBytes);
+    wordOffsets.assign(cachedOffsets, cachedOffsets + header.numWords);
+    wordLengths.resize(header.numWords);
+    for (size_t i = 0; i < numWords(); i++) {
+        wordLengths[i] = cachedOffsets[i + 1] - cachedOffsets[i];
+        int numWordsInDict = static_cast<int>(i);
+        checkBeginEnd(wordAt(i), numWordsInDict);
+    } // for (i)
+
+    if (stats) {
+        stats->wordsRead += numWords();
+    }
+
+    useNeighborGraph = true;
+} // loadCache()
+
+void LetterManClass::writeCache() {
+    if (buildCacheFile.empty()) {
+        return;
+    }
+    PhaseTimer timer(stats ? &stats->cacheMs : nullptr);
+
+    // the letters are already packed back to back, only the end is missing
+    std::vector<uint32_t> cachedOffsets(wordOffsets);
+    cachedOffsets.push_back(static_cast<uint32_t>(wordLetters.size()));
+
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> targets;
+    buildSimilarityGraph(offsets, targets);
+
+    CacheHeader header;
+    std::memcpy(header.magic, cacheMagic, sizeof(cacheMagic));
+    header.version = cacheVersion;
+    header.modeFlags = modeFlags();
+    header.dictHash = dictHash;
+    header.numWords = numWords();
+    header.numEdges = targets.size();
+    header.wordBytes = wordLetters.size();
+
+    // write next to the target and rename, so readers never map a partial file
+    std::string tempFile = buildCacheFile + ".tmp";
+    std::ofstream cacheStream(tempFile, std::ios::binary | std::ios::trunc);
+    const char zeros[8] = {};
+    auto writeSection = [&](const void *bytes, size_t numBytes) {
+        cacheStream.write(static_cast<const char *>(bytes), 
+                          static_cast<std::streamsize>(numBytes));
+        cacheStream.write(zeros, static_cast<std::streamsize>((8 - numBytes % 8) % 8));
+    };
+    writeSection(&header, sizeof(header));
+    writeSection(cachedOffsets.data(), cachedOffsets.size() * sizeof(uint32_t));
+    writeSection(wordLetters.data(), wordLetters.size());
+    writeSection(offsets.data(), offsets.size() * sizeof(uint32_t));
+    writeSection(targets.data(), targets.size() * sizeof(uint32_t));
+    cacheStream.close();
+
+    if (!cacheStream || std::rename(tempFile.c_str(), buildCacheFile.c_str()) != 0) {
+        std::cerr << "Cache file could not be written: " << buildCacheFile << "\n";
+        exit(1);
+    }
+} // writeCache()
+
+void LetterManClass::runParallel(size_t numTasks, const std::function<void(size_t)> &task) {
+    if (threadPool) {
+        threadPool->run(numTasks, task);
+        return;
+    }
+    for (size_t i = 0; i < numTasks; i++) {
+        task(i);
+    }
+} // runParallel()
+
+// polynomial hash of a word, sum of letter i times keyBase^i, so a key 
+// that masks, swaps or deletes one letter is a few multiplications away
+const uint64_t keyBase = 0x9E3779B97F4A7C15ULL;
+
+constexpr uint64_t inverseOf(uint64_t odd) {
+    // Newton's iteration, each step doubles the correct low bits
+    uint64_t inverse = odd;
+    for (int i = 0; i < 5; i++) {
+        inverse *= 2 - odd * inverse;
+    }
+    return inverse;
+} // inverseOf()
+
+const uint64_t keyBaseInverse = inverseOf(keyBase);
+
+inline uint32_t finishKeyHash(uint64_t hash, size_t keyLength, int mode, size_t letterIdx) {
+    hash += keyLength * 0xD6E8FEB86659FD93ULL + static_cast<uint64_t>(mode) * 0xA0761D6478BD642FULL + 
+            (letterIdx + 1) * 0xE7037ED1A0B428DBULL;
+    // splitmix64's finalizer, so the radix digits are evenly spread
+    hash = (hash ^ (hash >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    hash = (hash ^ (hash >> 27)) * 0x94D049BB133111EBULL;
+    return static_cast<uint32_t>((hash ^ (hash >> 31)) >> 32);
+} // finishKeyHash()
+
+size_t LetterManClass::countKeys(size_t wordIdx) {
+    std::string_view word = wordAt(wordIdx);
+    size_t numKeys = 0;
+    if (changeIsSpecified) {
+        numKeys += word.size();
+    }
+    for (size_t j = 0; j < word.size(); j++) {
+        if (swapIsSpecified && j + 1 < word.size() && word[j] != word[j + 1]) {
+            numKeys++;
+        }
+        if (lengthIsSpecified && (j == 0 || word[j] != word[j - 1])) {
+            numKeys++;
+        }
+    } // for (j)
+    return numKeys + (lengthIsSpecified ? 1 : 0);
+} // countKeys()
+
+void LetterManClass::emitKeys(size_t wordIdx, KeyEntry *entries, 
+                              std::vector<uint64_t> &prefixHash) {
+    // the same keys bucketWord() makes, hashed instead of spelled out
+    std::string_view word = wordAt(wordIdx);
+    size_t wordSize = word.size();
+    auto letter = [&](size_t j) { return static_cast<uint64_t>(static_cast<unsigned char>(word[j])); };
+    auto emit = [&](uint64_t hash, size_t keyLength, ModificationMode mode, size_t letterIdx) {
+        // a deletion must hash like the whole word it is matched against
+        size_t hashedIdx = mode == lengthMode ? wholeWordKey : letterIdx;
+        *entries++ = {finishKeyHash(hash, keyLength, mode, hashedIdx), 
+                      static_cast<uint32_t>(wordIdx), static_cast<uint8_t>(mode), 
+                      static_cast<uint16_t>(letterIdx)};
+    };
+
+    // prefixHash[j] hashes the first j letters, power is keyBase^j
+    prefixHash.resize(wordSize + 1);
+    prefixHash[0] = 0;
+    uint64_t power = 1;
+    for (size_t j = 0; j < wordSize; j++) {
+        prefixHash[j + 1] = prefixHash[j] + letter(j) * power;
+        power *= keyBase;
+    } // for (j)
+    uint64_t wordHash = prefixHash[wordSize];
+
+    power = 1;
+    for (size_t j = 0; j < wordSize; j++) {
+        if (changeIsSpecified) {
+            emit(wordHash - letter(j) * power, wordSize, changeMode, j);
+        } // the masked letter counts as zero
+
+        if (swapIsSpecified && j + 1 < wordSize && word[j] != word[j + 1]) {
+            uint64_t lowLetter = std::min(letter(j), letter(j + 1));
+            uint64_t highLetter = std::max(letter(j), letter(j + 1));
+            emit(wordHash + (lowLetter - letter(j)) * power + 
+                 (highLetter - letter(j + 1)) * power * keyBase, wordSize, swapMode, j);
+        } // the pair in sorted order
+
+        if (lengthIsSpecified && (j == 0 || word[j] != word[j - 1])) {
+            emit(prefixHash[j] + (wordHash - prefixHash[j + 1]) * keyBaseInverse, 
+                 wordSize - 1, lengthMode, j);
+        } // the letters past j move down one place
+
+        power *= keyBase;
+    } // for (j)
+
+    if (lengthIsSpecified) {
+        emit(wordHash, wordSize, lengthMode, wholeWordKey);
+    }
+} // emitKeys()
+
+bool LetterManClass::keysAreSimilar(const KeyEntry &entryA, const KeyEntry &entryB) {
+    // equal hashes only make two words candidates, the letters decide
+    if (entryA.mode != entryB.mode) {
+        return false;
+    }
+
+    std::string_view wordA = wordAt(entryA.wordIdx);
+    std::string_view wordB = wordAt(entryB.wordIdx);
+    size_t letterIdx = entryA.letterIdx;
+
+    if (entryA.mode == lengthMode) {
+        if ((entryA.letterIdx == wholeWordKey) == (entryB.letterIdx == wholeWordKey)) {
+            return false;
+        } // both whole words or both deletions
+        if (entryA.letterIdx == wholeWordKey) {
+            std::swap(wordA, wordB);
+            letterIdx = entryB.letterIdx;
+        } // wordA is the longer word from here on
+        return wordA.size() == wordB.size() + 1 && 
+               wordA.substr(0, letterIdx) == wordB.substr(0, letterIdx) && 
+               wordA.substr(letterIdx + 1) == wordB.substr(letterIdx);
+    } // if length
+
+    if (wordA.size() != wordB.size() || entryA.letterIdx != entryB.letterIdx) {
+        return false;
+    }
+    size_t suffixIdx = letterIdx + (entryA.mode == swapMode ? 2 : 1);
+    if (wordA.substr(0, letterIdx) != wordB.substr(0, letterIdx) || 
+        wordA.substr(suffixIdx) != wordB.substr(suffixIdx) || 
+        wordA[letterIdx] == wordB[letterIdx]) {
+        return false;
+    } // equal words share every key but are not neighbors
+
+    return entryA.mode == changeMode || 
+           (wordA[letterIdx] == wordB[letterIdx + 1] && 
+            wordA[letterIdx + 1] == wordB[letterIdx]);
+} // keysAreSimilar()
+
+void LetterManClass::buildSimilarityGraph(std::vector<uint32_t> &offsets, 
+                                          std::vector<uint32_t> &targets) {
+    // every word emits its masked keys, sorting brings the words that 
+    // share one together, and each run of a key holds all of its edges
+    size_t numTasks = threadPool ? threadPool->size() * 4 : 1;
+    auto taskRange = [&](size_t task, size_t numItems) {
+        return std::make_pair(numItems * task / numTasks, numItems * (task + 1) / numTasks);
+    };
+
+    // step 1: emit the keys of every word, each task into its own slice
+    std::vector<size_t> keyOffsets(numWords() + 1, 0);
+    runParallel(numTasks, [&](size_t task) {
+        std::pair<size_t, size_t> range = taskRange(task, numWords());
+        for (size_t i = range.first; i < range.second; i++) {
+            keyOffsets[i + 1] = countKeys(i);
+        }
+    });
+    for (size_t i = 0; i < numWords(); i++) {
+        keyOffsets[i + 1] += keyOffsets[i];
+    }
+
+    std::vector<KeyEntry> keys(keyOffsets.back());
+    runParallel(numTasks, [&](size_t task) {
+        std::vector<uint64_t> prefixHash;
+        std::pair<size_t, size_t> range = taskRange(task, numWords());
+        for (size_t i = range.first; i < range.second; i++) {
+            emitKeys(i, keys.data() + keyOffsets[i], prefixHash);
+        }
+    });
+
+    // step 2: LSD radix sort on the hash, a byte per pass; stable, so a 
+    // run keeps its words in index order
+    std::vector<KeyEntry> sortedKeys(keys.size());
+    std::vector<std::array<size_t, 256>> digitCounts(numTasks);
+    for (int shift = 0; shift < 32; shift += 8) {
+        runParallel(numTasks, [&](size_t task) {
+            std::array<size_t, 256> &counts = digitCounts[task];
+            counts.fill(0);
+            std::pair<size_t, size_t> range = taskRange(task, keys.size());
+            for (size_t i = range.first; i < range.second; i++) {
+                counts[(keys[i].hash >> shift) & 0xFF]++;
+            }
+        });
+
+        // a digit's slots are split among the tasks in task order
+        size_t numPlaced = 0;
+        for (size_t digit = 0; digit < 256; digit++) {
+            for (std::array<size_t, 256> &counts : digitCounts) {
+                size_t count = counts[digit];
+                counts[digit] = numPlaced;
+                numPlaced += count;
+            } // for (counts)
+        } // for (digit)
+
+        runParallel(numTasks, [&](size_t task) {
+            std::array<size_t, 256> &slots = digitCounts[task];
+            std::pair<size_t, size_t> range = taskRange(task, keys.size());
+            for (size_t i = range.first; i < range.second; i++) {
+                sortedKeys[slots[(keys[i].hash >> shift) & 0xFF]++] = keys[i];
+            }
+        });
+        keys.swap(sortedKeys);
+    } // for (shift)
+    std::vector<KeyEntry>().swap(sortedKeys);
+
+    // step 3: every pair inside a run that passes the letter check is an 
+    // edge, a task takes the runs that start in its range
+    std::vector<std::vector<uint64_t>> taskEdges(numTasks);
+    runParallel(numTasks, [&](size_t task) {
+        std::pair<size_t, size_t> range = taskRange(task, keys.size());
+        auto runStart = [&](size_t i) { 
+            while (i > 0 && i < keys.size() && keys[i].hash == keys[i - 1].hash) {
+                i++;
+            }
+            return i;
+        };
+
+        std::vector<uint64_t> &edges = taskEdges[task];
+        size_t runEnd;
+        for (size_t i = runStart(range.first); i < runStart(range.second); i = runEnd) {
+            runEnd = i + 1;
+            while (runEnd < keys.size() && keys[runEnd].hash == keys[i].hash) {
+                runEnd++;
+            }
+
+            for (size_t a = i; a < runEnd; a++) {
+                for (size_t b = a + 1; b < runEnd; b++) {
+                    if (keysAreSimilar(keys[a], keys[b])) {
+                        assert(areSimilarWords(wordAt(keys[a].wordIdx), wordAt(keys[b].wordIdx)));
+                        edges.push_back(uint64_t(keys[a].wordIdx) << 32 | keys[b].wordIdx);
+                    }
+                } // for (b)
+            } // for (a)
+        } // for (i)
+    });
+    std::vector<KeyEntry>().swap(keys);
+
+    // step 4: CSR with both directions of every edge, each list sorted 
+    // by index as findNeighbors() returns it
+    std::vector<std::atomic<uint32_t>> degrees(numWords());
+    runParallel(numTasks, [&](size_t task) {
+        for (uint64_t edge : taskEdges[task]) {
+            degrees[edge >> 32].fetch_add(1, std::memory_order_relaxed);
+            degrees[edge & 0xFFFFFFFF].fetch_add(1, std::memory_order_relaxed);
+        }
+    });
+
+    std::vector<uint32_t> edgeOffsets(numWords() + 1, 0);
+    for (size_t i = 0; i < numWords(); i++) {
+        edgeOffsets[i + 1] = edgeOffsets[i] + degrees[i].load(std::memory_order_relaxed);
+        degrees[i].store(edgeOffsets[i], std::memory_order_relaxed);
+    } // degrees is each list's fill cursor from here on
+
+    std::vector<uint32_t> edgeTargets(edgeOffsets.back());
+    runParallel(numTasks, [&](size_t task) {
+        for (uint64_t edge : taskEdges[task]) {
+            uint32_t wordA = static_cast<uint32_t>(edge >> 32);
+            uint32_t wordB = static_cast<uint32_t>(edge & 0xFFFFFFFF);
+            edgeTargets[degrees[wordA].fetch_add(1, std::memory_order_relaxed)] = wordB;
+            edgeTargets[degrees[wordB].fetch_add(1, std::memory_order_relaxed)] = wordA;
+        }
+        std::vector<uint64_t>().swap(taskEdges[task]);
+    });
+
+    // a pair of words can share more than one key, count each edge once
+    std::vector<uint32_t> listSizes(numWords());
+    runParallel(numTasks, [&](size_t task) {
+        std::pair<size_t, size_t> range = taskRange(task, numWords());
+        for (size_t i = range.first; i < range.second; i++) {
+            uint32_t *list = edgeTargets.data() + edgeOffsets[i];
+            uint32_t *listEnd = edgeTargets.data() + edgeOffsets[i + 1];
+            std::sort(list, listEnd);
+            listSizes[i] = static_cast<uint32_t>(std::unique(list, listEnd) - list);
+        }
+    });
+
+    offsets.assign(1, 0);
+    offsets.reserve(numWords() + 1);
+    targets.clear();
+    targets.reserve(edgeTargets.size());
+    for (size_t i = 0; i < numWords(); i++) {
+        targets.insert(targets.end(), edgeTargets.begin() + edgeOffsets[i], 
+                       edgeTargets.begin() + edgeOffsets[i] + listSizes[i]);
+        offsets.push_back(static_cast<uint32_t>(targets.size()));
+    } // for (i)
+} // buildSimilarityGraph()
+
+template <int modeSet>
+void LetterManClass::selectModeSet() {
+    similarWordsTest = &LetterManClass::areSimilarWords<modeSet>;
+    if (stats) {
+        scanNeighborsStep = &LetterManClass::scanNeighbors<true, modeSet>;
+        scanDictionaryStep = &LetterManClass::scanDictionary<true, modeSet>;
+        scanParentStep = &LetterManClass::scanParent<true, modeSet>;
+    } // --stats is read before this, so counting is chosen once as well
+    else {
+        scanNeighborsStep = &LetterManClass::scanNeighbors<false, modeSet>;
+        scanDictionaryStep = &LetterManClass::scanDictionary<false, modeSet>;
+        scanParentStep = &LetterManClass::scanParent<false, modeSet>;
+    }
+} // selectModeSet()
+
+template <int modeSet>
+bool LetterManClass::modeIsOn(int modeBit) {
+    if (modeSet != runtimeModeSet) {
+        return (modeSet & modeBit) != 0;
+    } // known when compiling, every test on it folds away
+
+    return modeBit == changeBit ? changeIsSpecified : 
+           modeBit == swapBit ? swapIsSpecified : lengthIsSpecified;
+} // modeIsOn()
+
+bool LetterManClass::areSimilarWords(std::string_view investingWord, 
+                                     std::string_view currentWord) {
+    return (this->*similarWordsTest)(investingWord, currentWord);
+} // areSimilarWords()
+
+template <int modeSet>
+bool LetterManClass::areSimilarWords(std::string_view investingWord, 
+                                     std::string_view currentWord) {
+    const bool changeIsOn = modeIsOn<modeSet>(changeBit);
+    const bool swapIsOn = modeIsOn<modeSet>(swapBit);
+    const bool lengthIsOn = modeIsOn<modeSet>(lengthBit);
+    
+    size_t invstWordSize = investingWord.size();
+    size_t crntWordSize = currentWord.size();
+
+    if ((invstWordSize > crntWordSize && invstWordSize - crntWordSize > 1) || 
+        (crntWordSize > invstWordSize && crntWordSize - invstWordSize > 1)) {
+        return false;
+    } // if diff of size > 1, not similar
+    
+    else if (invstWordSize == crntWordSize) {
+        if (!(changeIsOn || swapIsOn)) {
+            return false;
+        }
+
+        else if (changeIsOn && swapIsOn) {
+            int numDiffLetter = 0;
+            bool isSwapped = false;
+
+            for (size_t i = 0; i < invstWordSize; i++) {
+                if (investingWord[i] != currentWord[i]) {
+                    numDiffLetter++;
+                    if (i < invstWordSize - 1 && 
+                        investingWord[i] == currentWord[i + 1] &&
+                        investingWord[i + 1] == currentWord[i]) {
+                        isSwapped = true;
                     }
                 }
             } // for (i)
             return (numDiffLetter == 1 && !isSwapped) || 
                    (numDiffLetter == 2 && isSwapped);
         } // we can both change and swap
-        else if (changeIsSpecified && !swapIsSpecified) {
+        else if (changeIsOn && !swapIsOn) {
             int numDiffLetter = 0;
             for (size_t i = 0; i < invstWordSize; i++) {
-                if (investingWord.word[i] != currentWord.word[i]) {
+                if (investingWord[i] != currentWord[i]) {
                     numDiffLetter++;
                 }
             } // for (i)
@@ -460,11 +1987,11 @@ bool LetterManClass::areSimilarWords(Word &investingWord,
             bool isSwapped = false;
 
             for (size_t i = 0; i < invstWordSize; i++) {
-                if (investingWord.word[i] != currentWord.word[i]) {
+                if (investingWord[i] != currentWord[i]) {
                     numDiffLetter++;
                     if (i < invstWordSize - 1 && 
-                        investingWord.word[i] == currentWord.word[i + 1] &&
-                        investingWord.word[i + 1] == currentWord.word[i]) {
+                        investingWord[i] == currentWord[i + 1] &&
+                        investingWord[i + 1] == currentWord[i]) {
                         isSwapped = true;
                     }
                 }
@@ -474,7 +2001,7 @@ bool LetterManClass::areSimilarWords(Word &investingWord,
     } // if same size
 
     else {
-        if (!lengthIsSpecified) {
+        if (!lengthIsOn) {
             return false;
         }
         else {
@@ -483,7 +2010,7 @@ bool LetterManClass::areSimilarWords(Word &investingWord,
                 size_t j = 0;
 
                 while (i < invstWordSize && j < crntWordSize) {
-                    if (investingWord.word[i] == currentWord.word[j]) {
+                    if (investingWord[i] == currentWord[j]) {
                         i++;
                         j++;
                     } // if same letter at some index, move forward
@@ -498,7 +2025,7 @@ bool LetterManClass::areSimilarWords(Word &investingWord,
                 size_t j = 0;
 
                 while (i < crntWordSize && j < invstWordSize) {
-                    if (currentWord.word[i] == investingWord.word[j]) {
+                    if (currentWord[i] == investingWord[j]) {
                         i++;
                         j++;
                     } // if same letter at some index, move forward
@@ -513,151 +2040,2060 @@ bool LetterManClass::areSimilarWords(Word &investingWord,
     return true;
 } // areSimilarWords()
 
-bool LetterManClass::search() {
-    std::deque<int> searchContainer;
-    int currentWordIdx;
-    
-    // step 0: set initial currentWord as beginWord, send it to searchContainer
-    dictionary[beginWordIdx].isDiscovered = true;
-    numDiscovered++;
-    searchContainer.push_back(beginWordIdx);
+void LetterManClass::makeSwapKey(std::string_view word, size_t letterIdx, 
+                                 std::string &key) {
+    // mark where the pair starts, then put the pair in sorted order
+    key.assign(word, 0, letterIdx);
+    key += '\0';
+    key += std::min(word[letterIdx], word[letterIdx + 1]);
+    key += std::max(word[letterIdx], word[letterIdx + 1]);
+    key.append(word, letterIdx + 2, std::string::npos);
+} // makeSwapKey()
 
-    while (!dictionary[endWordIdx].isDiscovered) {
-        // step 1: remove next word from searchContainer, set to currentWord
-        if (searchContainer.size() == 0) {
+void LetterManClass::padWords() {
+#ifdef LETTERMAN_SIMD
+    size_t longestWord = 0;
+    for (uint32_t wordLength : wordLengths) {
+        if (wordLength != removedLength) {
+            longestWord = std::max(longestWord, static_cast<size_t>(wordLength));
+        }
+    } // for (wordLength)
+
+    if (longestWord <= 16) {
+        paddedSlot = 16;
+        equalMask = equalMask16;
+    }
+    else {
+        paddedSlot = 32;
+        equalMask = __builtin_cpu_supports("avx2") ? equalMask32Avx2 : equalMask32Sse2;
+    } // longer words than the slot keep using areSimilarWords()
+
+    // one spare slot, the kernel reads a word shifted by one letter
+    paddedWords.assign((numWords() + 1) * paddedSlot, '\0');
+    for (size_t i = 0; i < numWords(); i++) {
+        if (wordLengths[i] <= paddedSlot) {
+            std::memcpy(&paddedWords[i * paddedSlot], &wordLetters[wordOffsets[i]], 
+                        wordLengths[i]);
+        }
+    } // for (i)
+#endif
+} // padWords()
+
+bool LetterManClass::packWord(std::string_view word, uint64_t &packedWord) {
+    if (word.size() > packedMaxLetters) {
+        return false;
+    }
+
+    packedWord = 0;
+    for (size_t i = 0; i < word.size(); i++) {
+        if (word[i] < 'a' || word[i] > 'z') {
             return false;
         }
+        packedWord |= static_cast<uint64_t>(word[i] - 'a' + 1) << (5 * i);
+    } // for (i)
+    return true;
+} // packWord()
 
-        if (stackIsSpecified) {
-            currentWordIdx = searchContainer.back();
-            searchContainer.pop_back();
-        } // if stack
-        else {
-            currentWordIdx = searchContainer.front();
-            searchContainer.pop_front();
-        } // else: queue
+bool LetterManClass::packWords() {
+    packedWords.resize(numWords());
+    for (size_t i = 0; i < numWords(); i++) {
+        if (wordLengths[i] == removedLength) {
+            packedWords[i] = 0;
+        } // never compared, its length rules it out first
+        else if (!packWord(wordAt(i), packedWords[i])) {
+            packedWords.clear();
+            return false;
+        } // one word too long or not lowercase, keep the other kernels
+    } // for (i)
+    return true;
+} // packWords()
 
-        // step 2: taking a loop of the dictionary, change features and add to sc if similar
-        for (size_t i = 0; i < dictionary.size(); i++) {
-            if (!dictionary[i].isDiscovered && areSimilarWords(dictionary[i], dictionary[currentWordIdx])) {
-                dictionary[i].isDiscovered = true;
-                numDiscovered++;
-                dictionary[i].prevWordIdx = currentWordIdx;
+template <int modeSet>
+bool LetterManClass::arePackedWordsSimilar(size_t investingIdx, size_t currentIdx) {
+    const bool changeIsOn = modeIsOn<modeSet>(changeBit);
+    const bool swapIsOn = modeIsOn<modeSet>(swapBit);
+    uint64_t invstWord = packedWords[investingIdx];
+    uint64_t crntWord = packedWords[currentIdx];
+    size_t invstWordSize = wordLengths[investingIdx];
+    size_t crntWordSize = wordLengths[currentIdx];
+
+    if (invstWordSize == crntWordSize) {
+        if (!(changeIsOn || swapIsOn)) {
+            return false;
+        }
 
-                searchContainer.push_back(static_cast<int>(i));
+        // fold every letter's five bits into its lowest one
+        uint64_t diffBits = invstWord ^ crntWord;
+        uint64_t diffLetters = (diffBits | diffBits >> 1 | diffBits >> 2 | 
+                                diffBits >> 3 | diffBits >> 4) & packedLowBits;
+        int numDiffLetter = __builtin_popcountll(diffLetters);
+        if (numDiffLetter == 1) {
+            return changeIsOn;
+        } // exactly one letter changed
+        if (numDiffLetter == 2 && swapIsOn) {
+            int shift = __builtin_ctzll(diffLetters);
+            uint64_t invstPair = (invstWord >> shift) & 0x3FF;
+            uint64_t crntPair = (crntWord >> shift) & 0x3FF;
+            return diffLetters == (uint64_t(0x21) << shift) && 
+                   invstPair == (((crntPair & 0x1F) << 5) | (crntPair >> 5));
+        } // two adjacent letters differ, they must be swapped
+        return false;
+    } // if same size
 
-                if (dictionary[endWordIdx].isDiscovered) {
-                    break;
-                }
-            } // if investigated word is not discovered and similar word to prev
-        } // iterating the dictionary
+    uint64_t shorterWord = invstWordSize < crntWordSize ? invstWord : crntWord;
+    uint64_t longerWord = invstWordSize < crntWordSize ? crntWord : invstWord;
 
-        // step 3: check whether endWord is discovered using while loop
-    } // while searchContainer not empty
-    
-    // no solution
-    if (!dictionary[endWordIdx].isDiscovered) {
+    // the longer word has a letter where the shorter one ends, so they 
+    // differ somewhere; past the first difference the longer word must 
+    // be the shorter one shifted by a letter
+    uint64_t diffBits = shorterWord ^ longerWord;
+    uint64_t diffLetters = (diffBits | diffBits >> 1 | diffBits >> 2 | 
+                            diffBits >> 3 | diffBits >> 4) & packedLowBits;
+    int shift = __builtin_ctzll(diffLetters);
+    return (shorterWord >> shift) == (longerWord >> (shift + 5));
+} // arePackedWordsSimilar()
+
+template <int modeSet>
+bool LetterManClass::arePaddedWordsSimilar(size_t investingIdx, size_t currentIdx) {
+    const bool changeIsOn = modeIsOn<modeSet>(changeBit);
+    const bool swapIsOn = modeIsOn<modeSet>(swapBit);
+    size_t invstWordSize = wordLengths[investingIdx];
+    size_t crntWordSize = wordLengths[currentIdx];
+    const char *invstWord = &paddedWords[investingIdx * paddedSlot];
+    const char *crntWord = &paddedWords[currentIdx * paddedSlot];
+
+    if (invstWordSize == crntWordSize) {
+        if (!(changeIsOn || swapIsOn)) {
+            return false;
+        }
+
+        uint32_t diffLetters = ~equalMask(invstWord, crntWord) & lowBits(invstWordSize);
+        int numDiffLetter = __builtin_popcount(diffLetters);
+        if (numDiffLetter == 1) {
+            return changeIsOn;
+        } // exactly one letter changed
+        if (numDiffLetter == 2 && swapIsOn) {
+            int i = __builtin_ctz(diffLetters);
+            return diffLetters == (3u << i) && 
+                   invstWord[i] == crntWord[i + 1] && invstWord[i + 1] == crntWord[i];
+        } // two letters differ, they must be an adjacent swap
         return false;
-    } // if endWord never be discovered
+    } // if same size
 
-    // prepare for outputs
+    const char *shorterWord = invstWordSize < crntWordSize ? invstWord : crntWord;
+    const char *longerWord = invstWordSize < crntWordSize ? crntWord : invstWord;
+    size_t shorterSize = std::min(invstWordSize, crntWordSize);
+
+    // the longer word may have one extra letter at the first difference, 
+    // after which it must match the shorter word shifted by one
+    int firstDiff = __builtin_ctz(~equalMask(shorterWord, longerWord));
+    uint32_t shiftedEqual = equalMask(shorterWord, longerWord + 1);
+    uint32_t mustMatch = lowBits(shorterSize) & ~lowBits(static_cast<size_t>(firstDiff));
+    return (shiftedEqual & mustMatch) == mustMatch;
+} // arePaddedWordsSimilar()
+
+template <bool countStats, int modeSet>
+bool LetterManClass::areSimilarIndices(size_t investingIdx, size_t currentIdx) {
+    size_t invstWordSize = wordLengths[investingIdx];
+    size_t crntWordSize = wordLengths[currentIdx];
+
+    // the same cheap rejections as areSimilarWords(), before any loads
+    if (invstWordSize + 1 < crntWordSize || crntWordSize + 1 < invstWordSize || 
+        (invstWordSize != crntWordSize && !modeIsOn<modeSet>(lengthBit))) {
+        if (countStats) {
+            stats->sizeRejections++;
+        }
+        return false;
+    } // if diff of size > 1, or insert and delete are not allowed
+
+    bool similar;
+    if (!packedWords.empty()) {
+        similar = arePackedWordsSimilar<modeSet>(investingIdx, currentIdx);
+    } // if the whole dictionary is packed
+    else if (paddedSlot != 0 && invstWordSize <= paddedSlot && crntWordSize <= paddedSlot) {
+        similar = arePaddedWordsSimilar<modeSet>(investingIdx, currentIdx);
+    } // if both words fit the kernel
     else {
-        Word temp = dictionary[endWordIdx];
-        path.push_back(endWordIdx);
-        while (temp.prevWordIdx != -1) {
-            path.push_back(temp.prevWordIdx);
-            temp = dictionary[temp.prevWordIdx];
-        } // while not backtradking to beginWord
-    } // else: found a path to endWord
+        similar = areSimilarWords<modeSet>(wordAt(investingIdx), wordAt(currentIdx));
+    }
 
-    return true;
-} // search()
+    if (countStats) {
+        countSimilarity(investingIdx, currentIdx, similar);
+    }
+    return similar;
+} // areSimilarIndices()
 
-std::string LetterManClass::printModification(Word &wordToModify, Word &wordAfterModify) {
-    size_t sizeBeforeMdf = wordToModify.word.size();
-    size_t sizeAfterMdf = wordAfterModify.word.size();
+void LetterManClass::countSimilarity(size_t investingIdx, size_t currentIdx, 
+                                     bool similar) {
+    if (wordLengths[investingIdx] != wordLengths[currentIdx]) {
+        stats->modeChecks[lengthMode]++;
+        stats->modePasses[lengthMode] += similar;
+        return;
+    } // only length mode can pass words of different sizes
 
-    std::string outputStr;
+    if (!(changeIsSpecified || swapIsSpecified)) {
+        stats->sizeRejections++;
+        return;
+    } // the same size is not enough when only length mode is on
 
-    if (sizeBeforeMdf == sizeAfterMdf) {
-        for (size_t i = 0; i < sizeBeforeMdf; i++) {
-            if (wordToModify.word[i] != wordAfterModify.word[i]) {
-                if (i == sizeAfterMdf - 1) {
-                    outputStr = "c," + std::to_string(i) + 
-                                "," + wordAfterModify.word[i] + "\n";
-                    return outputStr;
-                } // if modification happened at the last letter
-                else {
-                    if (wordToModify.word[i + 1] != wordAfterModify.word[i + 1]) {
-                        outputStr = "s," + std::to_string(i) + "\n";
-                        return outputStr;
-                    } // if two ajacent letters differ, swapped happened
-                    else {
-                        outputStr = "c," + std::to_string(i) + 
-                                    "," + wordAfterModify.word[i] + "\n";
-                        return outputStr;
-                    } // else: change happened
-                } // else: modification not happened at the last letter
-            } // if modification happened at index i
-        } // for (i)
-    } // if size not changed, change or swap was done
+    // a passing pair differs in one letter for a change, two for a swap
+    std::string_view investingWord = wordAt(investingIdx);
+    std::string_view currentWord = wordAt(currentIdx);
+    size_t numDiffLetter = 0;
+    for (size_t i = 0; i < investingWord.size(); i++) {
+        numDiffLetter += investingWord[i] != currentWord[i];
+    }
 
-    else {
-        if (sizeAfterMdf > sizeBeforeMdf) {
-            // insert was done
-            for (size_t i = 0; i < sizeBeforeMdf; i++) {
-                if (wordToModify.word[i] != wordAfterModify.word[i]) {
-                    outputStr = "i," + std::to_string(i) + 
-                                "," + wordAfterModify.word[i] + "\n";
-                    return outputStr;
-                } // if insert happened at index i
-            } // for (i)
-            outputStr = "i," + std::to_string(sizeAfterMdf - 1) + 
-                        "," + wordAfterModify.word[sizeAfterMdf - 1] + "\n";
-            return outputStr;
-        } // if insert was done
-        else {
-            for (size_t i = 0; i < sizeAfterMdf; ++i) {
-                if (wordAfterModify.word[i] != wordToModify.word[i]) {
-                    outputStr = "d," + std::to_string(i) + "\n";
-                    return outputStr;
-                } // if delete happened at index i
+    if (changeIsSpecified) {
+        stats->modeChecks[changeMode]++;
+        stats->modePasses[changeMode] += similar && numDiffLetter == 1;
+    }
+    if (swapIsSpecified) {
+        stats->modeChecks[swapMode]++;
+        stats->modePasses[swapMode] += similar && numDiffLetter == 2;
+    }
+} // countSimilarity()
+
+void LetterManClass::buildNeighborIndex() {
+    PhaseTimer timer(stats ? &stats->indexMs : nullptr);
+    useNeighborIndex = neighborEngine == "index" && !useNeighborGraph;
+    useProbeTable = neighborEngine == "probe" && !useNeighborGraph;
+    if (useProbeTable) {
+        buildProbeTable();
+        return;
+    } // if candidates are looked up instead
+
+    if (!useNeighborIndex) {
+        if (!useNeighborGraph && !packWords()) {
+            padWords();
+        }
+        return;
+    } // if the scan is used, prepare its kernel instead
+
+    if (numBucketedWords == numWords()) {
+        return;
+    } // the load pipeline already indexed every word
+
+    // one mode at a time, so only one set of buckets is being filled
+    if (changeIsSpecified) {
+        changeBuckets.reserve(numWords() * 4);
+        for (size_t i = 0; i < numWords(); i++) {
+            bucketWord(i, changeMode, true);
+        }
+    } // if change
+
+    if (swapIsSpecified) {
+        swapBuckets.reserve(numWords() * 4);
+        for (size_t i = 0; i < numWords(); i++) {
+            bucketWord(i, swapMode, true);
+        }
+    } // if swap
+
+    if (lengthIsSpecified) {
+        wordBuckets.reserve(numWords());
+        deletionBuckets.reserve(numWords() * 4);
+        for (size_t i = 0; i < numWords(); i++) {
+            bucketWord(i, lengthMode, true);
+        }
+    } // if length
+} // buildNeighborIndex()
+
+void LetterManClass::bucketWord(size_t wordIdx, ModificationMode mode, bool adding) {
+    // buckets stay sorted: words are only ever added past the last index
+    std::string_view word = wordAt(wordIdx);
+    std::string key;
+    auto update = [&](std::unordered_map<std::string, std::vector<int>> &buckets) {
+        std::vector<int> &bucket = buckets[key];
+        if (adding) {
+            bucket.push_back(static_cast<int>(wordIdx));
+            return;
+        }
+        bucket.erase(std::lower_bound(bucket.begin(), bucket.end(), 
+                                      static_cast<int>(wordIdx)));
+        if (bucket.empty()) {
+            buckets.erase(key);
+        }
+    };
+
+    if (mode == changeMode) {
+        key = word;
+        for (size_t j = 0; j < key.size(); j++) {
+            char maskedLetter = key[j];
+            key[j] = '\0';
+            update(changeBuckets);
+            key[j] = maskedLetter;
+        } // for (j)
+    } // if change
+
+    if (mode == swapMode) {
+        for (size_t j = 0; j + 1 < word.size(); j++) {
+            if (word[j] != word[j + 1]) {
+                makeSwapKey(word, j, key);
+                update(swapBuckets);
+            } // swapping two equal letters changes nothing
+        } // for (j)
+    } // if swap
+
+    if (mode == lengthMode) {
+        key = word;
+        update(wordBuckets);
+
+        for (size_t j = 0; j < word.size(); j++) {
+            if (j > 0 && word[j] == word[j - 1]) {
+                continue;
+            } // deleting either letter of a run gives the same word
+            key.assign(word, 0, j);
+            key.append(word, j + 1, std::string::npos);
+            update(deletionBuckets);
+        } // for (j)
+    } // if length
+} // bucketWord()
+
+void LetterManClass::findNeighbors(int currentWordIdx, 
+                                   std::vector<int> &similarWords) {
+    similarWords.clear();
+
+    if (useNeighborGraph) {
+        similarWords.assign(graphTargets + graphOffsets[currentWordIdx], 
+                            graphTargets + graphOffsets[currentWordIdx + 1]);
+        return;
+    } // if the adjacency was loaded from a cache
+
+    if (useProbeTable) {
+        probeNeighbors(currentWordIdx, similarWords);
+        return;
+    } // if every candidate is looked up in the hash table
+
+    if (!useNeighborIndex) {
+        (this->*scanNeighborsStep)(currentWordIdx, similarWords, false);
+        return;
+    } // if the index was not built, scan the dictionary
+
+    std::string_view currentWord = wordAt(currentWordIdx);
+    std::string key;
+
+    if (changeIsSpecified) {
+        key = currentWord;
+        for (size_t j = 0; j < key.size(); j++) {
+            char maskedLetter = key[j];
+            key[j] = '\0';
+            auto bucket = changeBuckets.find(key);
+            key[j] = maskedLetter;
+
+            for (int i : bucket->second) {
+                if (wordLetters[wordOffsets[i] + j] != maskedLetter) {
+                    similarWords.push_back(i);
+                } // if differs exactly at the masked position
             } // for (i)
-            outputStr = "d," + std::to_string(sizeAfterMdf) + "\n";
-            return outputStr;
-        } // else: delete was done
-    } // else: size changed, insert or delete was done
-    return std::string();
-} // printModification()
 
-void LetterManClass::output() {
-    if (search()) {
-        size_t sizePath = path.size();
-        if (outputFormat == "W") {
-            std::cout << "Words in morph: " << sizePath << "\n";
-            while (sizePath > 0) {
-                std::cout << dictionary[path.back()].word << "\n";
-                path.pop_back();
-                sizePath--;
+            if (stats) {
+                stats->modeChecks[changeMode] += bucket->second.size();
             }
-        } // output by words
-        
-        if (outputFormat == "M") {
-            std::cout << "Words in morph: " << sizePath << "\n";
-            std::cout << beginWord << "\n"; // print beginWord
-            while (sizePath > 1) {
-                Word wordToModify = dictionary[path.back()];
-                path.pop_back();
-                sizePath--;
-                Word wordAfterModify = dictionary[path.back()];
-                std::cout << printModification(wordToModify, wordAfterModify);
+        } // for (j)
+
+        if (stats) {
+            stats->modePasses[changeMode] += similarWords.size();
+        }
+    } // if change
+
+    if (swapIsSpecified) {
+        size_t numFound = similarWords.size();
+        for (size_t j = 0; j + 1 < currentWord.size(); j++) {
+            if (currentWord[j] == currentWord[j + 1]) {
+                continue;
+            } // swapping two equal letters changes nothing
+            makeSwapKey(currentWord, j, key);
+            auto bucket = swapBuckets.find(key);
+
+            for (int i : bucket->second) {
+                if (wordLetters[wordOffsets[i] + j] != currentWord[j]) {
+                    similarWords.push_back(i);
+                } // if the pair is swapped rather than identical
+            } // for (i)
+
+            if (stats) {
+                stats->modeChecks[swapMode] += bucket->second.size();
             }
-        } // output by morph
-    } // if found solution
+        } // for (j)
 
-    else {
-        std::cout << "No solution, " 
-                  << std::to_string(numDiscovered) 
-                  << " words discovered.\n";
-    } // else: no solution
-} // output()
\ No newline at end of file
+        if (stats) {
+            stats->modePasses[swapMode] += similarWords.size() - numFound;
+        }
+    } // if swap
+
+    if (lengthIsSpecified) {
+        size_t numFound = similarWords.size();
+        key = currentWord;
+        auto longerWords = deletionBuckets.find(key);
+        if (longerWords != deletionBuckets.end()) {
+            similarWords.insert(similarWords.end(), 
+                                longerWords->second.begin(), 
+                                longerWords->second.end());
+        } // if a letter can be inserted into current word
+
+        for (size_t j = 0; j < currentWord.size(); j++) {
+            if (j > 0 && currentWord[j] == currentWord[j - 1]) {
+                continue;
+            } // deleting either letter of a run gives the same word
+            key.assign(currentWord, 0, j);
+            key.append(currentWord, j + 1, std::string::npos);
+
+            auto shorterWords = wordBuckets.find(key);
+            if (shorterWords != wordBuckets.end()) {
+                similarWords.insert(similarWords.end(), 
+                                    shorterWords->second.begin(), 
+                                    shorterWords->second.end());
+            } // if a letter can be deleted from current word
+        } // for (j)
+
+        if (stats) {
+            // every word in a length bucket is a neighbor, nothing is checked
+            stats->modeChecks[lengthMode] += similarWords.size() - numFound;
+            stats->modePasses[lengthMode] += similarWords.size() - numFound;
+        }
+    } // if length
+
+    // buckets are disjoint, restore the dictionary scan order
+    std::sort(similarWords.begin(), similarWords.end());
+} // findNeighbors()
+
+void LetterManClass::buildProbeTable() {
+    size_t numSlots = 16;
+    while (numSlots < numWords() * 2) {
+        numSlots *= 2;
+    } // at most half full, so probe runs stay short
+    probeSlots.assign(numSlots, 0);
+    probeMask = numSlots - 1;
+    nextSameWord.assign(numWords(), -1);
+
+    bool letterUsed[256] = {};
+    for (char letter : wordLetters) {
+        letterUsed[static_cast<unsigned char>(letter)] = true;
+    }
+    alphabet.clear();
+    for (int letter = 0; letter < 256; letter++) {
+        if (letterUsed[letter]) {
+            alphabet += static_cast<char>(letter);
+        }
+    } // for (letter)
+
+    // walk backwards so a chain lists equal words in dictionary order
+    for (size_t i = numWords(); i-- > 0; ) {
+        if (wordLengths[i] == removedLength) {
+            continue;
+        }
+        std::string_view word = wordAt(i);
+        size_t slot = hashBytes(word.data(), word.size(), hashSeed) & probeMask;
+        while (probeSlots[slot] != 0 && wordAt(probeSlots[slot] - 1) != word) {
+            slot = (slot + 1) & probeMask;
+        }
+
+        if (probeSlots[slot] != 0) {
+            nextSameWord[i] = static_cast<int>(probeSlots[slot] - 1);
+        } // a later copy of this word is already in the table
+        probeSlots[slot] = static_cast<uint32_t>(i + 1);
+    } // for (i)
+} // buildProbeTable()
+
+int LetterManClass::probeWord(std::string_view word) {
+    size_t slot = hashBytes(word.data(), word.size(), hashSeed) & probeMask;
+    while (probeSlots[slot] != 0) {
+        if (probeSlots[slot] != probeTombstone && wordAt(probeSlots[slot] - 1) == word) {
+            return static_cast<int>(probeSlots[slot] - 1);
+        }
+        slot = (slot + 1) & probeMask;
+    } // while the run of full slots goes on
+    return -1;
+} // probeWord()
+
+size_t LetterManClass::addProbedWords(std::string_view candidate, 
+                                      std::vector<int> &similarWords) {
+    size_t numFound = 0;
+    for (int i = probeWord(candidate); i != -1; i = nextSameWord[i]) {
+        similarWords.push_back(i);
+        numFound++;
+    } // every copy of the word is a neighbor, like the scan finds them
+    return numFound;
+} // addProbedWords()
+
+void LetterManClass::probeNeighbors(int currentWordIdx, std::vector<int> &similarWords) {
+    // candidates of different modes, or of one mode at different 
+    // positions, are different words, so nothing is found twice
+    std::string_view currentWord = wordAt(currentWordIdx);
+    std::string candidate(currentWord);
+    size_t numCandidates = 0;
+    size_t numFound = 0;
+
+    if (changeIsSpecified) {
+        for (size_t j = 0; j < candidate.size(); j++) {
+            for (char letter : alphabet) {
+                if (letter != currentWord[j]) {
+                    candidate[j] = letter;
+                    numFound += addProbedWords(candidate, similarWords);
+                    numCandidates++;
+                }
+            } // for (letter)
+            candidate[j] = currentWord[j];
+        } // for (j)
+
+        if (stats) {
+            stats->modeChecks[changeMode] += numCandidates;
+            stats->modePasses[changeMode] += numFound;
+            numCandidates = numFound = 0;
+        }
+    } // if change
+
+    if (swapIsSpecified) {
+        for (size_t j = 0; j + 1 < candidate.size(); j++) {
+            if (currentWord[j] != currentWord[j + 1]) {
+                std::swap(candidate[j], candidate[j + 1]);
+                numFound += addProbedWords(candidate, similarWords);
+                numCandidates++;
+                std::swap(candidate[j], candidate[j + 1]);
+            } // swapping two equal letters changes nothing
+        } // for (j)
+
+        if (stats) {
+            stats->modeChecks[swapMode] += numCandidates;
+            stats->modePasses[swapMode] += numFound;
+            numCandidates = numFound = 0;
+        }
+    } // if swap
+
+    if (lengthIsSpecified) {
+        for (size_t j = 0; j < currentWord.size(); j++) {
+            if (j > 0 && currentWord[j] == currentWord[j - 1]) {
+                continue;
+            } // deleting either letter of a run gives the same word
+            candidate.assign(currentWord, 0, j);
+            candidate.append(currentWord, j + 1, std::string::npos);
+            numFound += addProbedWords(candidate, similarWords);
+            numCandidates++;
+        } // for (j)
+
+        for (size_t j = 0; j <= currentWord.size(); j++) {
+            candidate.assign(currentWord, 0, j);
+            candidate += '\0';
+            candidate.append(currentWord, j, std::string::npos);
+            for (char letter : alphabet) {
+                if (j > 0 && currentWord[j - 1] == letter) {
+                    continue;
+                } // the same word as inserting before that letter
+                candidate[j] = letter;
+                numFound += addProbedWords(candidate, similarWords);
+                numCandidates++;
+            } // for (letter)
+        } // for (j)
+
+        if (stats) {
+            stats->modeChecks[lengthMode] += numCandidates;
+            stats->modePasses[lengthMode] += numFound;
+        }
+    } // if length
+
+    // restore the dictionary scan order
+    std::sort(similarWords.begin(), similarWords.end());
+} // probeNeighbors()
+
+int LetterManClass::probeParent(std::string_view candidate) {
+    for (int i = probeWord(candidate); i != -1; i = nextSameWord[i]) {
+        if (testBit(frontierWords, static_cast<size_t>(i))) {
+            return i;
+        }
+    } // for every copy of the word
+    return -1;
+} // probeParent()
+
+int LetterManClass::findFrontierParent(int wordIdx) {
+    // the neighbors findNeighbors() would list, but only until the first 
+    // one marked in frontierWords, which is as good a parent as any other
+    if (useNeighborGraph) {
+        for (uint32_t edge = graphOffsets[wordIdx]; edge < graphOffsets[wordIdx + 1]; edge++) {
+            if (testBit(frontierWords, graphTargets[edge])) {
+                return static_cast<int>(graphTargets[edge]);
+            }
+        } // for (edge)
+        return -1;
+    } // if the adjacency was loaded from a cache
+
+    std::string_view currentWord = wordAt(static_cast<size_t>(wordIdx));
+    std::string key(currentWord);
+    int parentIdx = -1;
+
+    if (useProbeTable) {
+        if (changeIsSpecified) {
+            for (size_t j = 0; j < key.size(); j++) {
+                for (char letter : alphabet) {
+                    if (letter != currentWord[j]) {
+                        key[j] = letter;
+                        parentIdx = probeParent(key);
+                        if (parentIdx != -1) {
+                            return parentIdx;
+                        }
+                    }
+                } // for (letter)
+                key[j] = currentWord[j];
+            } // for (j)
+        } // if change
+
+        if (swapIsSpecified) {
+            for (size_t j = 0; j + 1 < key.size(); j++) {
+                if (currentWord[j] != currentWord[j + 1]) {
+                    std::swap(key[j], key[j + 1]);
+                    parentIdx = probeParent(key);
+                    std::swap(key[j], key[j + 1]);
+                    if (parentIdx != -1) {
+                        return parentIdx;
+                    }
+                } // swapping two equal letters changes nothing
+            } // for (j)
+        } // if swap
+
+        if (lengthIsSpecified) {
+            for (size_t j = 0; j < currentWord.size(); j++) {
+                key.assign(currentWord, 0, j);
+                key.append(currentWord, j + 1, std::string::npos);
+                parentIdx = probeParent(key);
+                if (parentIdx != -1) {
+                    return parentIdx;
+                }
+            } // for (j)
+
+            for (size_t j = 0; j <= currentWord.size(); j++) {
+                key.assign(currentWord, 0, j);
+                key += '\0';
+                key.append(currentWord, j, std::string::npos);
+                for (char letter : alphabet) {
+                    key[j] = letter;
+                    parentIdx = probeParent(key);
+                    if (parentIdx != -1) {
+                        return parentIdx;
+                    }
+                } // for (letter)
+            } // for (j)
+        } // if length
+        return -1;
+    } // if every candidate is looked up in the hash table
+
+    if (changeIsSpecified) {
+        for (size_t j = 0; j < key.size(); j++) {
+            char maskedLetter = key[j];
+            key[j] = '\0';
+            auto bucket = changeBuckets.find(key);
+            key[j] = maskedLetter;
+
+            for (int i : bucket->second) {
+                if (testBit(frontierWords, static_cast<size_t>(i)) && 
+                    wordLetters[wordOffsets[i] + j] != maskedLetter) {
+                    return i;
+                }
+            } // for (i)
+        } // for (j)
+    } // if change
+
+    if (swapIsSpecified) {
+        for (size_t j = 0; j + 1 < currentWord.size(); j++) {
+            if (currentWord[j] == currentWord[j + 1]) {
+                continue;
+            } // swapping two equal letters changes nothing
+            makeSwapKey(currentWord, j, key);
+            auto bucket = swapBuckets.find(key);
+
+            for (int i : bucket->second) {
+                if (testBit(frontierWords, static_cast<size_t>(i)) && 
+                    wordLetters[wordOffsets[i] + j] != currentWord[j]) {
+                    return i;
+                }
+            } // for (i)
+        } // for (j)
+    } // if swap
+
+    if (lengthIsSpecified) {
+        key = currentWord;
+        auto longerWords = deletionBuckets.find(key);
+        if (longerWords != deletionBuckets.end()) {
+            for (int i : longerWords->second) {
+                if (testBit(frontierWords, static_cast<size_t>(i))) {
+                    return i;
+                }
+            } // for (i)
+        } // if a letter can be inserted into current word
+
+        for (size_t j = 0; j < currentWord.size(); j++) {
+            key.assign(currentWord, 0, j);
+            key.append(currentWord, j + 1, std::string::npos);
+            auto shorterWords = wordBuckets.find(key);
+            if (shorterWords != wordBuckets.end()) {
+                for (int i : shorterWords->second) {
+                    if (testBit(frontierWords, static_cast<size_t>(i))) {
+                        return i;
+                    }
+                } // for (i)
+            } // if a letter can be deleted from current word
+        } // for (j)
+    } // if length
+
+    return -1;
+} // findFrontierParent()
+
+void LetterManClass::insertProbeWord(size_t wordIdx) {
+    nextSameWord.push_back(-1);
+    if (numWords() * 2 > probeSlots.size()) {
+        buildProbeTable();
+        return;
+    } // rebuilding also clears the tombstones
+
+    std::string_view word = wordAt(wordIdx);
+    for (char letter : word) {
+        if (alphabet.find(letter) == std::string::npos) {
+            alphabet += letter;
+        }
+    } // for (letter)
+
+    int sameWordIdx = probeWord(word);
+    if (sameWordIdx != -1) {
+        while (nextSameWord[sameWordIdx] != -1) {
+            sameWordIdx = nextSameWord[sameWordIdx];
+        }
+        nextSameWord[sameWordIdx] = static_cast<int>(wordIdx);
+        return;
+    } // the new word is the last copy of a word already in the table
+
+    size_t slot = hashBytes(word.data(), word.size(), hashSeed) & probeMask;
+    while (probeSlots[slot] != 0 && probeSlots[slot] != probeTombstone) {
+        slot = (slot + 1) & probeMask;
+    }
+    probeSlots[slot] = static_cast<uint32_t>(wordIdx + 1);
+} // insertProbeWord()
+
+void LetterManClass::eraseProbeWord(std::string_view word) {
+    // every copy goes at once, so the whole chain leaves with its slot
+    size_t slot = hashBytes(word.data(), word.size(), hashSeed) & probeMask;
+    while (probeSlots[slot] != 0) {
+        if (probeSlots[slot] != probeTombstone && wordAt(probeSlots[slot] - 1) == word) {
+            probeSlots[slot] = probeTombstone;
+            return;
+        }
+        slot = (slot + 1) & probeMask;
+    } // while the run of full slots goes on
+} // eraseProbeWord()
+
+template <bool countStats, int modeSet>
+void LetterManClass::scanNeighbors(int currentWordIdx, std::vector<int> &similarWords, 
+                                   bool undiscoveredOnly) {
+    similarWords.clear();
+    for (size_t i = 0; i < numWords(); i++) {
+        if (!(undiscoveredOnly && testBit(discoveredWords, i)) && 
+            areSimilarIndices<countStats, modeSet>(i, static_cast<size_t>(currentWordIdx))) {
+            similarWords.push_back(static_cast<int>(i));
+        }
+    } // for (i)
+} // scanNeighbors()
+
+template <bool countStats, int modeSet>
+void LetterManClass::scanDictionary(int currentWordIdx, std::deque<int> &searchContainer) {
+    for (size_t i = 0; i < numWords(); i++) {
+        if (!testBit(discoveredWords, i) && 
+            areSimilarIndices<countStats, modeSet>(i, static_cast<size_t>(currentWordIdx))) {
+            setBit(discoveredWords, i);
+            numDiscovered++;
+            prevWordIdx[i] = currentWordIdx;
+
+            searchContainer.push_back(static_cast<int>(i));
+
+            if (testBit(discoveredWords, endWordIdx)) {
+                break;
+            }
+        } // if investigated word is not discovered and similar word to prev
+    } // iterating the dictionary
+} // scanDictionary()
+
+template <bool countStats, int modeSet>
+int LetterManClass::scanParent(size_t wordIdx, const std::vector<int> &frontier) {
+    for (int frontierIdx : frontier) {
+        if (areSimilarIndices<countStats, modeSet>(wordIdx, static_cast<size_t>(frontierIdx))) {
+            return frontierIdx;
+        }
+    } // for (frontierIdx)
+    return -1;
+} // scanParent()
+
+void LetterManClass::startSearch() {
+    // one bit per word, clearing it is far cheaper than visiting the words
+    discoveredWords.assign((numWords() + 63) / 64, 0);
+    prevWordIdx.resize(numWords(), -1);
+    numDiscovered = 0;
+    path.clear();
+} // startSearch()
+
+bool LetterManClass::search() {
+    if (astarIsSpecified) {
+        return astarSearch();
+    }
+
+    if (bidirectionalIsSpecified) {
+        return bidirectionalSearch();
+    }
+
+    if (hybridIsSpecified) {
+        return hybridSearch();
+    }
+
+    if (allShortestIsSpecified) {
+        return allShortestSearch();
+    }
+
+    if (threadPool && queueIsSpecified) {
+        return threadedSearch();
+    }
+
+    std::deque<int> searchContainer;
+    int currentWordIdx;
+    
+    startSearch();
+
+    // step 0: set initial currentWord as beginWord, send it to searchContainer
+    setBit(discoveredWords, beginWordIdx);
+    prevWordIdx[beginWordIdx] = -1;
+    numDiscovered++;
+    searchContainer.push_back(beginWordIdx);
+
+    while (!testBit(discoveredWords, endWordIdx)) {
+        // step 1: remove next word from searchContainer, set to currentWord
+        if (searchContainer.size() == 0) {
+            return false;
+        }
+
+        if (stackIsSpecified) {
+            currentWordIdx = searchContainer.back();
+            searchContainer.pop_back();
+        } // if stack
+        else {
+            currentWordIdx = searchContainer.front();
+            searchContainer.pop_front();
+        } // else: queue
+
+        // step 2: taking a loop of the dictionary, change features and add to sc if similar
+        if (useNeighborIndex || useNeighborGraph || useProbeTable) {
+            findNeighbors(currentWordIdx, neighbors);
+            for (int i : neighbors) {
+                if (!testBit(discoveredWords, i)) {
+                    setBit(discoveredWords, i);
+                    numDiscovered++;
+                    prevWordIdx[i] = currentWordIdx;
+
+                    searchContainer.push_back(i);
+
+                    if (testBit(discoveredWords, endWordIdx)) {
+                        break;
+                    }
+                } // if neighbor is not discovered
+            } // iterating the neighbors
+        } // if neighbors come from the index or cache
+        else {
+            (this->*scanDictionaryStep)(currentWordIdx, searchContainer);
+        } // else: scan the whole dictionary
+
+        if (stats) {
+            stats->peakContainerSize = std::max(stats->peakContainerSize, 
+                                                searchContainer.size());
+        }
+
+        // step 3: check whether endWord is discovered using while loop
+    } // while searchContainer not empty
+    
+    // no solution
+    if (!testBit(discoveredWords, endWordIdx)) {
+        return false;
+    } // if endWord never be discovered
+
+    // prepare for outputs
+    else {
+        int temp = endWordIdx;
+        path.push_back(endWordIdx);
+        while (prevWordIdx[temp] != -1) {
+            path.push_back(prevWordIdx[temp]);
+            temp = prevWordIdx[temp];
+        } // while not backtradking to beginWord
+    } // else: found a path to endWord
+
+    return true;
+} // search()
+
+bool LetterManClass::bidirectionalSearch() {
+    startSearch();
+    nextWordIdx.resize(numWords(), -1);
+    backwardWords.assign(discoveredWords.size(), 0);
+    searchDepth.resize(numWords(), 0);
+
+    // a word belongs to exactly one side: discoveredWords marks the side 
+    // grown from beginWord, backwardWords the side grown from endWord
+    std::vector<int> forwardFrontier(1, beginWordIdx);
+    std::vector<int> backwardFrontier(1, endWordIdx);
+    std::vector<int> nextFrontier;
+
+    setBit(discoveredWords, beginWordIdx);
+    prevWordIdx[beginWordIdx] = -1;
+    searchDepth[beginWordIdx] = 0;
+    numDiscovered++;
+
+    if (beginWordIdx == endWordIdx) {
+        path.push_back(endWordIdx);
+        std::cerr << "Bidirectional search discovered " << numDiscovered << " words.\n";
+        return true;
+    } // if nothing to morph
+
+    setBit(backwardWords, endWordIdx);
+    nextWordIdx[endWordIdx] = -1;
+    searchDepth[endWordIdx] = 0;
+    numDiscovered++;
+
+    int meetForwardIdx = -1;
+    int meetBackwardIdx = -1;
+    int meetLength = 0;
+
+    while (!forwardFrontier.empty() && !backwardFrontier.empty()) {
+        // grow the smaller side by one whole level, so every meeting 
+        // found in this level can be compared before picking the shortest
+        bool growForward = forwardFrontier.size() <= backwardFrontier.size();
+        std::vector<int> &frontier = growForward ? forwardFrontier : backwardFrontier;
+        nextFrontier.clear();
+
+        for (int currentWordIdx : frontier) {
+            findNeighbors(currentWordIdx, neighbors);
+            for (int i : neighbors) {
+                bool onForwardSide = testBit(discoveredWords, i);
+                bool onBackwardSide = testBit(backwardWords, i);
+                bool onOtherSide = growForward ? onBackwardSide : onForwardSide;
+
+                if (onOtherSide) {
+                    int length = searchDepth[currentWordIdx] + 1 + searchDepth[i];
+                    if (meetForwardIdx == -1 || length < meetLength) {
+                        meetLength = length;
+                        meetForwardIdx = growForward ? currentWordIdx : i;
+                        meetBackwardIdx = growForward ? i : currentWordIdx;
+                    }
+                } // if the other side already reached this word
+                else if (!onForwardSide && !onBackwardSide) {
+                    if (growForward) {
+                        setBit(discoveredWords, i);
+                        prevWordIdx[i] = currentWordIdx;
+                    }
+                    else {
+                        setBit(backwardWords, i);
+                        nextWordIdx[i] = currentWordIdx;
+                    }
+                    searchDepth[i] = searchDepth[currentWordIdx] + 1;
+                    numDiscovered++;
+                    nextFrontier.push_back(i);
+                } // if neither side reached this word
+            } // iterating the neighbors
+        } // iterating the frontier
+
+        frontier.swap(nextFrontier);
+
+        if (stats) {
+            stats->peakContainerSize = std::max(stats->peakContainerSize, 
+                                                forwardFrontier.size() + backwardFrontier.size());
+        }
+
+        if (meetForwardIdx != -1) {
+            break;
+        } // if the two sides met during this level
+    } // while both sides can still grow
+
+    std::cerr << "Bidirectional search discovered " << numDiscovered << " words.\n";
+
+    if (meetForwardIdx == -1) {
+        return false;
+    } // if one side ran out of words before meeting the other
+
+    // path runs from endWord back to beginWord, like search() leaves it
+    std::vector<int> backwardHalf;
+    for (int i = meetBackwardIdx; i != -1; i = nextWordIdx[i]) {
+        backwardHalf.push_back(i);
+    }
+    path.assign(backwardHalf.rbegin(), backwardHalf.rend());
+    for (int i = meetForwardIdx; i != -1; i = prevWordIdx[i]) {
+        path.push_back(i);
+    }
+
+    return true;
+} // bidirectionalSearch()
+
+int LetterManClass::estimateDistance(int wordIdx) {
+    std::string_view word = wordAt(wordIdx);
+    std::string_view targetWord = wordAt(endWordIdx);
+
+    if (lengthIsSpecified) {
+        return std::abs(static_cast<int>(word.size()) - static_cast<int>(targetWord.size()));
+    } // an insert or delete can move every letter, only the size is certain
+
+    // without length mode every word has endWord's size
+    int numDiffLetter = 0;
+    for (size_t i = 0; i < word.size(); i++) {
+        numDiffLetter += word[i] != targetWord[i];
+    }
+    // a change fixes one letter, a swap at most two
+    return swapIsSpecified ? (numDiffLetter + 1) / 2 : numDiffLetter;
+} // estimateDistance()
+
+bool LetterManClass::astarSearch() {
+    startSearch();
+    searchDepth.resize(numWords(), 0);
+
+    // the bound never drops by more than one per step, so the first 
+    // time a word leaves the frontier its depth is final and no word 
+    // is expanded twice
+    std::priority_queue<AStarEntry, std::vector<AStarEntry>, AStarOrder> frontier;
+
+    setBit(discoveredWords, beginWordIdx);
+    prevWordIdx[beginWordIdx] = -1;
+    searchDepth[beginWordIdx] = 0;
+    numDiscovered++;
+    frontier.push({estimateDistance(beginWordIdx), 0, beginWordIdx});
+
+    while (!frontier.empty()) {
+        AStarEntry current = frontier.top();
+        frontier.pop();
+
+        if (current.depth != searchDepth[current.wordIdx]) {
+            continue;
+        } // a shorter path to this word was pushed after this entry
+
+        if (current.wordIdx == endWordIdx) {
+            for (int i = endWordIdx; i != -1; i = prevWordIdx[i]) {
+                path.push_back(i);
+            }
+            return true;
+        } // endWord left the frontier, its path is a shortest one
+
+        findNeighbors(current.wordIdx, neighbors);
+        int depth = current.depth + 1;
+        for (int i : neighbors) {
+            if (testBit(discoveredWords, i) && searchDepth[i] <= depth) {
+                continue;
+            } // if already reached at least as fast
+
+            if (!testBit(discoveredWords, i)) {
+                setBit(discoveredWords, i);
+                numDiscovered++;
+            }
+            prevWordIdx[i] = current.wordIdx;
+            searchDepth[i] = depth;
+            frontier.push({depth + estimateDistance(i), depth, i});
+        } // iterating the neighbors
+
+        if (stats) {
+            stats->peakContainerSize = std::max(stats->peakContainerSize, frontier.size());
+        }
+    } // while words are left to expand
+
+    return false;
+} // astarSearch()
+
+bool LetterManClass::threadedSearch() {
+    startSearch();
+    if (frontierClaim.size() != numWords()) {
+        frontierClaim = std::vector<std::atomic<int>>(numWords());
+        for (std::atomic<int> &claim : frontierClaim) {
+            claim.store(INT_MAX, std::memory_order_relaxed);
+        }
+    } // claims are put back to INT_MAX after every level
+
+    std::vector<int> frontier(1, beginWordIdx);
+    std::vector<int> nextFrontier;
+
+    setBit(discoveredWords, beginWordIdx);
+    prevWordIdx[beginWordIdx] = -1;
+    numDiscovered++;
+
+    // a whole BFS level is what search() pops between two levels of its 
+    // queue, so the level is expanded in parallel and then merged the way 
+    // search() would have visited it: by frontier position, then by index
+    const size_t chunkSize = 64;
+    while (!testBit(discoveredWords, endWordIdx) && !frontier.empty()) {
+        size_t numChunks = (frontier.size() + chunkSize - 1) / chunkSize;
+        if (frontierNeighbors.size() < frontier.size()) {
+            frontierNeighbors.resize(frontier.size());
+        }
+
+        // step 1: every frontier word claims its undiscovered neighbors, 
+        // the earliest frontier word wins as it does in search()
+        threadPool->run(numChunks, [&](size_t chunk) {
+            size_t chunkEnd = std::min(frontier.size(), (chunk + 1) * chunkSize);
+            for (size_t k = chunk * chunkSize; k < chunkEnd; k++) {
+                std::vector<int> &similarWords = frontierNeighbors[k];
+                int currentWordIdx = frontier[k];
+
+                if (useNeighborIndex || useNeighborGraph || useProbeTable) {
+                    findNeighbors(currentWordIdx, similarWords);
+                    similarWords.erase(std::remove_if(similarWords.begin(), similarWords.end(), 
+                                       [&](int i) { 
+                                           return testBit(discoveredWords, i); 
+                                       }), similarWords.end());
+                } // if neighbors come from the index or cache
+                else {
+                    (this->*scanNeighborsStep)(currentWordIdx, similarWords, true);
+                } // else: scan the whole dictionary
+
+                for (int i : similarWords) {
+                    int claim = frontierClaim[i].load(std::memory_order_relaxed);
+                    while (static_cast<int>(k) < claim && 
+                           !frontierClaim[i].compare_exchange_weak(claim, static_cast<int>(k))) {
+                    }
+                } // for (i)
+            } // for (k)
+        });
+
+        // step 2: keep only the neighbors this frontier word won
+        threadPool->run(numChunks, [&](size_t chunk) {
+            size_t chunkEnd = std::min(frontier.size(), (chunk + 1) * chunkSize);
+            for (size_t k = chunk * chunkSize; k < chunkEnd; k++) {
+                std::vector<int> &similarWords = frontierNeighbors[k];
+                similarWords.erase(std::remove_if(similarWords.begin(), similarWords.end(), 
+                                   [&](int i) { 
+                                       return frontierClaim[i].load() != static_cast<int>(k); 
+                                   }), similarWords.end());
+            } // for (k)
+        });
+
+        // step 3: discover in search() order, stop right after endWord
+        nextFrontier.clear();
+        for (size_t k = 0; k < frontier.size(); k++) {
+            for (int i : frontierNeighbors[k]) {
+                frontierClaim[i].store(INT_MAX, std::memory_order_relaxed);
+                if (testBit(discoveredWords, endWordIdx)) {
+                    continue;
+                } // past endWord, only release the claim
+
+                setBit(discoveredWords, i);
+                prevWordIdx[i] = frontier[k];
+                numDiscovered++;
+                nextFrontier.push_back(i);
+            } // for (i)
+        } // for (k)
+
+        frontier.swap(nextFrontier);
+
+        if (stats) {
+            stats->peakContainerSize = std::max(stats->peakContainerSize, frontier.size());
+        }
+    } // while endWord not discovered and the level is not empty
+
+    if (!testBit(discoveredWords, endWordIdx)) {
+        return false;
+    } // if endWord never be discovered
+
+    for (int i = endWordIdx; i != -1; i = prevWordIdx[i]) {
+        path.push_back(i);
+    } // while not backtracking to beginWord
+
+    return true;
+} // threadedSearch()
+
+bool LetterManClass::hybridSearch() {
+    startSearch();
+    frontierWords.assign(discoveredWords.size(), 0);
+
+    std::vector<int> frontier;
+    std::vector<int> nextFrontier;
+
+    // a top-down step checks every edge of the frontier, a bottom-up step 
+    // at most every edge left unexplored, and fewer as each word stops at 
+    // its first frontier neighbor; only a cached graph knows the degrees, 
+    // elsewhere every word counts as one edge
+    auto degreeOf = [&](int wordIdx) -> size_t {
+        return useNeighborGraph ? graphOffsets[wordIdx + 1] - graphOffsets[wordIdx] : 1;
+    };
+    size_t numLiveWords = numWords() - numRemovedWords;
+    size_t unexploredEdges = useNeighborGraph ? graphOffsets[numWords()] : numLiveWords;
+    size_t frontierEdges = 0;
+    size_t nextFrontierEdges = degreeOf(beginWordIdx);
+    size_t prevFrontierSize = 0;
+    bool bottomUp = false;
+
+    auto discover = [&](int wordIdx, int parentIdx) {
+        setBit(discoveredWords, static_cast<size_t>(wordIdx));
+        prevWordIdx[wordIdx] = parentIdx;
+        numDiscovered++;
+        nextFrontier.push_back(wordIdx);
+        nextFrontierEdges += degreeOf(wordIdx);
+        unexploredEdges -= degreeOf(wordIdx);
+    };
+
+    discover(beginWordIdx, -1);
+    frontier.swap(nextFrontier);
+
+    while (!testBit(discoveredWords, endWordIdx) && !frontier.empty()) {
+        frontierEdges = nextFrontierEdges;
+        nextFrontierEdges = 0;
+        nextFrontier.clear();
+
+        // the scan compares the frontier with every undiscovered word in 
+        // either direction, and only bottom-up stops a word at its first match
+        if (!useNeighborIndex && !useNeighborGraph && !useProbeTable) {
+            bottomUp = true;
+        }
+        else if (!bottomUp) {
+            bottomUp = frontierEdges * hybridAlpha > unexploredEdges;
+        }
+        else {
+            bottomUp = frontier.size() >= prevFrontierSize || 
+                       frontier.size() * hybridBeta > numLiveWords;
+        }
+        prevFrontierSize = frontier.size();
+
+        if (!bottomUp) {
+            for (size_t k = 0; k < frontier.size(); k++) {
+                findNeighbors(frontier[k], neighbors);
+                for (int i : neighbors) {
+                    if (testBit(discoveredWords, static_cast<size_t>(i))) {
+                        continue;
+                    }
+                    discover(i, frontier[k]);
+                    if (i == endWordIdx) {
+                        break;
+                    }
+                } // for (i)
+
+                if (testBit(discoveredWords, endWordIdx)) {
+                    break;
+                }
+            } // for (k)
+
+            if (stats) {
+                stats->topDownLevels++;
+            }
+        } // if top-down
+        else {
+            for (int wordIdx : frontier) {
+                setBit(frontierWords, static_cast<size_t>(wordIdx));
+            }
+
+            // every undiscovered word takes the first frontier word next to 
+            // it as its parent, words found here are not in frontierWords, 
+            // so none of them is taken for a parent in the same level
+            for (size_t block = 0; block < discoveredWords.size() && 
+                                   !testBit(discoveredWords, endWordIdx); block++) {
+                uint64_t undiscovered = ~discoveredWords[block];
+                while (undiscovered != 0) {
+                    size_t wordIdx = block * 64 + static_cast<size_t>(__builtin_ctzll(undiscovered));
+                    undiscovered &= undiscovered - 1;
+                    if (wordIdx >= numWords()) {
+                        break;
+                    } // padding past the last word
+                    if (wordLengths[wordIdx] == removedLength) {
+                        continue;
+                    } // a removed word has no letters to look up
+
+                    int parentIdx;
+                    if (useNeighborIndex || useNeighborGraph || useProbeTable) {
+                        parentIdx = findFrontierParent(static_cast<int>(wordIdx));
+                    } // if neighbors come from the index or cache
+                    else {
+                        parentIdx = (this->*scanParentStep)(wordIdx, frontier);
+                    } // else: only the frontier can hold a parent, so the 
+                      // scan compares against it alone
+                    if (parentIdx == -1) {
+                        continue;
+                    }
+
+                    discover(static_cast<int>(wordIdx), parentIdx);
+                    if (static_cast<int>(wordIdx) == endWordIdx) {
+                        break;
+                    }
+                } // while the block has undiscovered words
+            } // for (block)
+
+            for (int wordIdx : frontier) {
+                frontierWords[static_cast<size_t>(wordIdx) >> 6] = 0;
+            } // clears whole blocks, only frontier bits were ever set
+
+            if (stats) {
+                stats->bottomUpLevels++;
+            }
+        } // else: bottom-up
+
+        frontier.swap(nextFrontier);
+
+        if (stats) {
+            stats->peakContainerSize = std::max(stats->peakContainerSize, frontier.size());
+        }
+    } // while endWord not discovered and the level is not empty
+
+    if (!testBit(discoveredWords, endWordIdx)) {
+        return false;
+    } // if endWord never be discovered
+
+    for (int i = endWordIdx; i != -1; i = prevWordIdx[i]) {
+        path.push_back(i);
+    } // while not backtracking to beginWord
+
+    return true;
+} // hybridSearch()
+
+bool LetterManClass::allShortestSearch() {
+    startSearch();
+    searchDepth.resize(numWords());
+    dagChildRange.assign(numWords(), std::make_pair(0u, 0u));
+    morphCounts.resize(numWords());
+    dagChildren.clear();
+    levelWords.assign(1, beginWordIdx);
+    levelOffsets.assign({0, 1});
+
+    setBit(discoveredWords, beginWordIdx);
+    prevWordIdx[beginWordIdx] = -1;
+    searchDepth[beginWordIdx] = 0;
+    numDiscovered++;
+
+    // whole levels are expanded, up to and including the one that 
+    // discovers endWord, so every parent of every word is known; a 
+    // neighbor one level down is a child whether or not it is new
+    int depth = 0;
+    while (!testBit(discoveredWords, endWordIdx) && 
+           levelOffsets[depth] < levelOffsets[depth + 1]) {
+        for (size_t k = levelOffsets[depth]; k < levelOffsets[depth + 1]; k++) {
+            int currentWordIdx = levelWords[k];
+            if (useNeighborIndex || useNeighborGraph || useProbeTable) {
+                findNeighbors(currentWordIdx, neighbors);
+            } // if neighbors come from the index or cache
+            else {
+                (this->*scanNeighborsStep)(currentWordIdx, neighbors, false);
+            } // else: scan the whole dictionary
+
+            uint32_t firstChild = static_cast<uint32_t>(dagChildren.size());
+            for (int i : neighbors) {
+                if (!testBit(discoveredWords, i)) {
+                    setBit(discoveredWords, i);
+                    numDiscovered++;
+                    searchDepth[i] = depth + 1;
+                    // the first parent is the one search() would keep
+                    prevWordIdx[i] = currentWordIdx;
+                    levelWords.push_back(i);
+                } // if neighbor is not discovered
+                else if (searchDepth[i] != depth + 1) {
+                    continue;
+                } // a word of this level or above is no child
+
+                dagChildren.push_back(i);
+            } // for (i)
+            dagChildRange[currentWordIdx] = std::make_pair(
+                firstChild, static_cast<uint32_t>(dagChildren.size()));
+        } // for (k)
+
+        levelOffsets.push_back(levelWords.size());
+        depth++;
+
+        if (stats) {
+            stats->peakContainerSize = std::max(stats->peakContainerSize, 
+                                                levelOffsets[depth + 1] - levelOffsets[depth]);
+        }
+    } // while endWord not discovered and the level is not empty
+
+    if (!testBit(discoveredWords, endWordIdx)) {
+        return false;
+    } // if endWord never be discovered
+
+    // count the morphs from the last level up, a word has as many as its 
+    // children together; endWord is alone in counting one
+    for (size_t k = levelOffsets[depth]; k < levelOffsets[depth + 1]; k++) {
+        morphCounts[levelWords[k]] = 0;
+    }
+    morphCounts[endWordIdx] = 1;
+    for (size_t k = levelOffsets[depth]; k > 0; k--) {
+        int wordIdx = levelWords[k - 1];
+        uint64_t numMorphs = 0;
+        for (uint32_t j = dagChildRange[wordIdx].first; j < dagChildRange[wordIdx].second; j++) {
+            uint64_t childMorphs = morphCounts[dagChildren[j]];
+            numMorphs = childMorphs > UINT64_MAX - numMorphs ? UINT64_MAX : numMorphs + childMorphs;
+        } // for (j)
+        morphCounts[wordIdx] = numMorphs;
+    } // for (k)
+
+    for (int i = endWordIdx; i != -1; i = prevWordIdx[i]) {
+        path.push_back(i);
+    } // the first morph, as search() finds it
+
+    return true;
+} // allShortestSearch()
+
+void LetterManClass::appendNumber(size_t number) {
+    char digits[20];
+    char *digitsEnd = std::to_chars(digits, digits + sizeof(digits), number).ptr;
+    outputBuffer.append(digits, digitsEnd);
+} // appendNumber()
+
+void LetterManClass::printModification(std::string_view wordToModify, 
+                                       std::string_view wordAfterModify) {
+    size_t sizeBeforeMdf = wordToModify.size();
+    size_t sizeAfterMdf = wordAfterModify.size();
+
+    if (sizeBeforeMdf == sizeAfterMdf) {
+        for (size_t i = 0; i < sizeBeforeMdf; i++) {
+            if (wordToModify[i] != wordAfterModify[i]) {
+                if (i != sizeAfterMdf - 1 && 
+                    wordToModify[i + 1] != wordAfterModify[i + 1]) {
+                    outputBuffer += "s,";
+                    appendNumber(i);
+                    outputBuffer += '\n';
+                } // if two ajacent letters differ, swapped happened
+                else {
+                    outputBuffer += "c,";
+                    appendNumber(i);
+                    outputBuffer += ',';
+                    outputBuffer += wordAfterModify[i];
+                    outputBuffer += '\n';
+                } // else: change happened, possibly at the last letter
+                return;
+            } // if modification happened at index i
+        } // for (i)
+    } // if size not changed, change or swap was done
+
+    else if (sizeAfterMdf > sizeBeforeMdf) {
+        // insert was done, at the first difference or else at the end
+        size_t i = 0;
+        while (i < sizeBeforeMdf && wordToModify[i] == wordAfterModify[i]) {
+            i++;
+        }
+        outputBuffer += "i,";
+        appendNumber(i);
+        outputBuffer += ',';
+        outputBuffer += wordAfterModify[i];
+        outputBuffer += '\n';
+    } // if insert was done
+
+    else {
+        // delete was done, at the first difference or else at the end
+        size_t i = 0;
+        while (i < sizeAfterMdf && wordAfterModify[i] == wordToModify[i]) {
+            i++;
+        }
+        outputBuffer += "d,";
+        appendNumber(i);
+        outputBuffer += '\n';
+    } // else: delete was done
+} // printModification()
+
+void LetterManClass::appendMorph() {
+    // path runs from endWord back to beginWord, words are printed 
+    // straight from the dictionary by index
+    size_t sizePath = path.size();
+    size_t numLetters = 0;
+    for (int wordIdx : path) {
+        numLetters += wordLengths[wordIdx];
+    }
+    // a modification line is at most "c,<index>,<letter>\n"
+    outputBuffer.reserve(outputBuffer.size() + 64 + numLetters + sizePath * 24);
+
+    outputBuffer += "Words in morph: ";
+    appendNumber(sizePath);
+    outputBuffer += '\n';
+
+    if (outputFormat == "W") {
+        for (size_t i = sizePath; i > 0; i--) {
+            outputBuffer += wordAt(path[i - 1]);
+            outputBuffer += '\n';
+        }
+    } // output by words
+    
+    if (outputFormat == "M") {
+        outputBuffer += beginWord; // print beginWord
+        outputBuffer += '\n';
+        for (size_t i = sizePath - 1; i > 0; i--) {
+            printModification(wordAt(path[i]), wordAt(path[i - 1]));
+        }
+    } // output by morph
+} // appendMorph()
+
+void LetterManClass::appendAllShortest() {
+    uint64_t numMorphs = morphCounts[beginWordIdx];
+    outputBuffer += "Shortest morphs: ";
+    appendNumber(numMorphs);
+    if (numMorphs == UINT64_MAX) {
+        outputBuffer += " or more";
+    } // the count saturates instead of wrapping around
+    outputBuffer += '\n';
+
+    // a depth-first walk of the DAG that only steps onto words with a 
+    // morph left, so it never backs out of a dead end and every path 
+    // is printed as soon as it is complete; it holds one path at a time
+    std::vector<std::pair<int, uint32_t>> walk;
+    walk.emplace_back(beginWordIdx, dagChildRange[beginWordIdx].first);
+    size_t numPrinted = 0;
+    while (!walk.empty() && numPrinted < morphLimit) {
+        int wordIdx = walk.back().first;
+        if (wordIdx == endWordIdx) {
+            path.clear();
+            for (size_t i = walk.size(); i > 0; i--) {
+                path.push_back(walk[i - 1].first);
+            }
+            appendMorph();
+            numPrinted++;
+            walk.pop_back();
+
+            if (outputBuffer.size() >= (size_t(1) << 16)) {
+                writeOutput();
+                outputBuffer.clear();
+            } // the morphs are streamed, never all held at once
+            continue;
+        } // if the walk reached endWord
+
+        uint32_t &childPos = walk.back().second;
+        if (childPos == dagChildRange[wordIdx].second) {
+            walk.pop_back();
+            continue;
+        } // every child of this word was walked
+
+        int childIdx = dagChildren[childPos++];
+        if (morphCounts[childIdx] != 0) {
+            walk.emplace_back(childIdx, dagChildRange[childIdx].first);
+        }
+    } // while morphs are left to print
+} // appendAllShortest()
+
+void LetterManClass::printMorph(bool morphFound) {
+    outputBuffer.clear();
+
+    if (!morphFound) {
+        outputBuffer += "No solution, ";
+        appendNumber(static_cast<size_t>(numDiscovered));
+        outputBuffer += " words discovered.\n";
+    } // if no solution
+    else if (allShortestIsSpecified) {
+        appendAllShortest();
+    } // else if every shortest morph is asked for
+    else {
+        appendMorph();
+    } // else: found solution
+
+    writeOutput();
+} // printMorph()
+
+void LetterManClass::writeOutput() {
+    // whatever went through std::cout before must come out first
+    std::cout.flush();
+
+    size_t numWritten = 0;
+    while (numWritten < outputBuffer.size()) {
+        ssize_t written = write(outputFd, outputBuffer.data() + numWritten, 
+                                outputBuffer.size() - numWritten);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        } // interrupted before anything was written
+        if (written < 0) {
+            std::cerr << "Output could not be written\n";
+            exit(1);
+        }
+        numWritten += static_cast<size_t>(written);
+    } // while part of the buffer is left
+} // writeOutput()
+
+void LetterManClass::output() {
+    if (!lengthIsSpecified && !changeIsSpecified && sortedBegin != sortedEnd) {
+        numDiscovered = 1;
+        printMorph(false);
+        return;
+    } // the answer wordShouldInDict() leaves when it keeps only the begin 
+      // and end word, a cache keeps the anagrams of the begin word too
+    if (!stats) {
+        printMorph(search());
+        return;
+    }
+
+    bool morphFound;
+    {
+        PhaseTimer timer(&stats->searchMs);
+        morphFound = search();
+    }
+    stats->numSearches++;
+    stats->wordsDiscovered += static_cast<size_t>(numDiscovered);
+    stats->longestPath = std::max(stats->longestPath, path.size());
+
+    PhaseTimer timer(&stats->outputMs);
+    printMorph(morphFound);
+} // output()
+
+int LetterManClass::findComponent(int wordIdx) {
+    while (componentParent[wordIdx] != wordIdx) {
+        componentParent[wordIdx] = componentParent[componentParent[wordIdx]];
+        wordIdx = componentParent[wordIdx];
+    } // path halving
+    return wordIdx;
+} // findComponent()
+
+void LetterManClass::labelComponents() {
+    componentParent.resize(numWords());
+    componentSize.assign(numWords(), 1);
+    for (size_t i = 0; i < numWords(); i++) {
+        componentParent[i] = static_cast<int>(i);
+    }
+
+    if (useNeighborGraph) {
+        for (size_t i = 0; i < numWords(); i++) {
+            findNeighbors(static_cast<int>(i), neighbors);
+            for (int j : neighbors) {
+                joinComponents(static_cast<int>(i), j);
+            } // for (j)
+        } // for (i)
+        componentsAreExact = true;
+        return;
+    } // if a cache already holds the graph
+
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> targets;
+    buildSimilarityGraph(offsets, targets);
+    for (size_t i = 0; i < numWords(); i++) {
+        for (uint32_t k = offsets[i]; k < offsets[i + 1]; k++) {
+            joinComponents(static_cast<int>(i), static_cast<int>(targets[k]));
+        } // for (k)
+    } // for (i)
+    componentsAreExact = true;
+} // labelComponents()
+
+void LetterManClass::joinComponents(int wordIdxA, int wordIdxB) {
+    int rootA = findComponent(wordIdxA);
+    int rootB = findComponent(wordIdxB);
+    if (rootA == rootB) {
+        return;
+    }
+    if (componentSize[rootA] < componentSize[rootB]) {
+        std::swap(rootA, rootB);
+    } // hang the smaller tree under the larger one
+    componentParent[rootB] = rootA;
+    componentSize[rootA] += componentSize[rootB];
+} // joinComponents()
+
+size_t LetterManClass::insertWord(std::string_view newWord) {
+    if (useNeighborGraph) {
+        useNeighborGraph = false;
+        buildNeighborIndex();
+    } // a cached adjacency cannot grow, switch to the chosen engine once
+
+    size_t wordIdx = numWords();
+    addWord(newWord);
+
+    if (useNeighborIndex) {
+        if (changeIsSpecified) {
+            bucketWord(wordIdx, changeMode, true);
+        }
+        if (swapIsSpecified) {
+            bucketWord(wordIdx, swapMode, true);
+        }
+        if (lengthIsSpecified) {
+            bucketWord(wordIdx, lengthMode, true);
+        }
+    }
+    else if (useProbeTable) {
+        insertProbeWord(wordIdx);
+    }
+    else if (!packedWords.empty()) {
+        packedWords.push_back(0);
+        if (!packWord(newWord, packedWords.back())) {
+            packedWords.clear();
+            padWords();
+        } // the new word does not fit, the whole scan falls back
+    }
+    else if (paddedSlot != 0) {
+        paddedWords.resize((numWords() + 1) * paddedSlot, '\0');
+        if (newWord.size() <= paddedSlot) {
+            std::memcpy(&paddedWords[wordIdx * paddedSlot], newWord.data(), newWord.size());
+        }
+    } // the scan only needs the word packed or padded for its kernel
+
+    // a new word can only merge components, so exact labels stay exact
+    componentParent.push_back(static_cast<int>(wordIdx));
+    componentSize.push_back(1);
+    findNeighbors(static_cast<int>(wordIdx), neighbors);
+    for (int i : neighbors) {
+        joinComponents(static_cast<int>(wordIdx), i);
+    } // for (i)
+
+    return neighbors.size();
+} // insertWord()
+
+size_t LetterManClass::eraseWord(int wordIdx) {
+    if (useNeighborGraph) {
+        useNeighborGraph = false;
+        buildNeighborIndex();
+    } // a cached adjacency cannot shrink, switch to the chosen engine once
+
+    findNeighbors(wordIdx, neighbors);
+
+    if (useNeighborIndex) {
+        if (changeIsSpecified) {
+            bucketWord(static_cast<size_t>(wordIdx), changeMode, false);
+        }
+        if (swapIsSpecified) {
+            bucketWord(static_cast<size_t>(wordIdx), swapMode, false);
+        }
+        if (lengthIsSpecified) {
+            bucketWord(static_cast<size_t>(wordIdx), lengthMode, false);
+        }
+    }
+    else if (useProbeTable && probeWord(wordAt(wordIdx)) != -1) {
+        eraseProbeWord(wordAt(wordIdx));
+    } // the first copy erased takes every copy out of the table
+
+    wordLengths[wordIdx] = removedLength;
+    numRemovedWords++;
+    componentsAreExact = false;
+    return neighbors.size();
+} // eraseWord()
+
+void LetterManClass::answerRequests() {
+    std::ifstream requestStream(requestFile);
+    if (!requestStream) {
+        std::cerr << "Request file could not be opened: " << requestFile << "\n";
+        exit(1);
+    }
+
+    // every copy of a word, the last one is what checkBeginEnd() would pick
+    std::unordered_map<std::string, std::vector<int>> wordIndex;
+    wordIndex.reserve(numWords());
+    for (size_t i = 0; i < numWords(); i++) {
+        wordIndex[std::string(wordAt(i))].push_back(static_cast<int>(i));
+    } // for (i)
+
+    // an exhausted search discovers exactly the begin word's component, 
+    // so unreachable requests are answered without searching
+    {
+        PhaseTimer timer(stats ? &stats->indexMs : nullptr);
+        labelComponents();
+    }
+
+    bool defaultStack = stackIsSpecified;
+    std::string line;
+    std::string token;
+    std::vector<std::string> requestWords;
+
+    while (getline(requestStream, line)) {
+        std::istringstream lineStream(line);
+        requestWords.clear();
+        stackIsSpecified = defaultStack;
+        queueIsSpecified = !defaultStack;
+
+        while (lineStream >> token) {
+            if (token.substr(0,2) == "//") {
+                break;
+            } // rest of the line is a comment
+            else if (token == "-s" || token == "--stack") {
+                stackIsSpecified = true;
+                queueIsSpecified = false;
+            }
+            else if (token == "-q" || token == "--queue") {
+                stackIsSpecified = false;
+                queueIsSpecified = true;
+            }
+            else {
+                requestWords.push_back(token);
+            }
+        } // while tokens on the line
+
+        if (requestWords.empty()) {
+            continue;
+        } // blank or comment line
+
+        if (requestWords[0] == "+" || requestWords[0] == "-") {
+            updateDictionary(requestWords, wordIndex);
+            continue;
+        } // the line adds or removes words instead
+
+        // every end word gets exactly one answer, errors included
+        if (requestWords.size() < 2) {
+            std::cout << "Request must name a begin and an end word\n" << std::flush;
+            continue;
+        }
+
+        beginWord = requestWords[0];
+        for (size_t i = 1; i < requestWords.size(); i++) {
+            endWord = requestWords[i];
+            answerRequest(wordIndex);
+            std::cout << std::flush;
+        } // for (i)
+    } // while requests remain
+} // answerRequests()
+
+void LetterManClass::answerRequest(std::unordered_map<std::string, std::vector<int>> &wordIndex) {
+    // a request line may switch to stack mode, getOptions() only checked 
+    // the command line
+    if (bidirectionalIsSpecified && stackIsSpecified) {
+        std::cout << "Bidirectional search requires queue mode\n";
+        return;
+    }
+
+    if (astarIsSpecified && stackIsSpecified) {
+        std::cout << "A* search requires queue mode\n";
+        return;
+    }
+
+    if (allShortestIsSpecified && stackIsSpecified) {
+        std::cout << "All shortest morphs require queue mode\n";
+        return;
+    }
+
+    if (hybridIsSpecified && stackIsSpecified) {
+        std::cout << "Hybrid search requires queue mode\n";
+        return;
+    }
+
+    if (!lengthIsSpecified && (beginWord.size() != endWord.size())) {
+        std::cout << "The first and last words must have " 
+                  << "the same length when length mode is off\n";
+        return;
+    }
+
+    auto beginIt = wordIndex.find(beginWord);
+    auto endIt = wordIndex.find(endWord);
+    if (beginIt == wordIndex.end()) {
+        std::cout << "Beginning word does not exist in the dictionary\n";
+        return;
+    }
+    if (endIt == wordIndex.end()) {
+        std::cout << "Ending word does not exist in the dictionary\n";
+        return;
+    }
+    beginWordIdx = beginIt->second.back();
+    endWordIdx = endIt->second.back();
+
+    sortedBegin = beginWord;
+    sortedEnd = endWord;
+    std::sort(sortedBegin.begin(), sortedBegin.end());
+    std::sort(sortedEnd.begin(), sortedEnd.end());
+    if (!lengthIsSpecified && !changeIsSpecified && sortedBegin != sortedEnd) {
+        std::cout << "No solution, 1 words discovered.\n";
+        return;
+    } // wordShouldInDict() would have left only the begin and end word
+
+    int beginComponent = findComponent(beginWordIdx);
+    if (beginComponent != findComponent(endWordIdx) && componentsAreExact && 
+        !bidirectionalIsSpecified) {
+        std::cout << "No solution, " << componentSize[beginComponent] 
+                  << " words discovered.\n";
+        return;
+    } // bidirectional search stops early and counts differently, and after 
+      // a removal only the search knows how many words are left to reach
+
+    if (treeCacheBytes > 0 && !bidirectionalIsSpecified && !astarIsSpecified && 
+        !allShortestIsSpecified && !hybridIsSpecified && 
+        !(threadPool && queueIsSpecified)) {
+        answerFromTree();
+        return;
+    } // a queue or stack search can be resumed for a later end word, 
+      // the other searches, and queue searches on the thread pool, run 
+      // from scratch for every request
+
+    output();
+} // answerRequest()
+
+SearchTree &LetterManClass::findSearchTree() {
+    for (auto tree = searchTrees.begin(); tree != searchTrees.end(); tree++) {
+        if (tree->beginWordIdx == beginWordIdx && 
+            tree->stackIsSpecified == stackIsSpecified) {
+            searchTrees.splice(searchTrees.begin(), searchTrees, tree);
+            return searchTrees.front();
+        }
+    } // for (tree)
+
+    // step 0 of search(): only beginWord is discovered and waiting
+    searchTrees.emplace_front();
+    SearchTree &tree = searchTrees.front();
+    tree.beginWordIdx = beginWordIdx;
+    tree.stackIsSpecified = stackIsSpecified;
+    tree.prevWordIdx.assign(numWords(), -1);
+    tree.discoveredWords.assign((numWords() + 63) / 64, 0);
+    setBit(tree.discoveredWords, beginWordIdx);
+    tree.searchContainer.push_back(beginWordIdx);
+    tree.numDiscovered = 1;
+    return tree;
+} // findSearchTree()
+
+void LetterManClass::growSearchTree(SearchTree &tree) {
+    // search() for any one end word pops the same words in the same order, 
+    // it only stops sooner, so every prevWordIdx here is the one it would 
+    // set; a popped word's neighbors are all taken, even past endWord, 
+    // because the search for a later end word takes them too
+    while (!testBit(tree.discoveredWords, endWordIdx) && !tree.searchContainer.empty()) {
+        int currentWordIdx;
+        if (tree.stackIsSpecified) {
+            currentWordIdx = tree.searchContainer.back();
+            tree.searchContainer.pop_back();
+        } // if stack
+        else {
+            currentWordIdx = tree.searchContainer.front();
+            tree.searchContainer.pop_front();
+        } // else: queue
+
+        findNeighbors(currentWordIdx, neighbors);
+        for (int i : neighbors) {
+            if (!testBit(tree.discoveredWords, i)) {
+                setBit(tree.discoveredWords, i);
+                tree.numDiscovered++;
+                tree.prevWordIdx[i] = currentWordIdx;
+                tree.searchContainer.push_back(i);
+            } // if neighbor is not discovered
+        } // iterating the neighbors
+
+        if (stats) {
+            stats->peakContainerSize = std::max(stats->peakContainerSize, 
+                                                tree.searchContainer.size());
+        }
+    } // while endWord is not discovered and words are waiting
+} // growSearchTree()
+
+void LetterManClass::trimSearchTrees() {
+    // the tree just used stays even when it alone is over the budget
+    size_t numBytes = 0;
+    for (auto tree = searchTrees.begin(); tree != searchTrees.end(); ) {
+        numBytes += tree->prevWordIdx.capacity() * sizeof(int) + 
+                    tree->discoveredWords.capacity() * sizeof(uint64_t) + 
+                    tree->searchContainer.size() * sizeof(int);
+        if (tree != searchTrees.begin() && numBytes > treeCacheBytes) {
+            tree = searchTrees.erase(tree, searchTrees.end());
+        }
+        else {
+            tree++;
+        }
+    } // for (tree)
+} // trimSearchTrees()
+
+void LetterManClass::answerFromTree() {
+    SearchTree &tree = findSearchTree();
+    {
+        PhaseTimer timer(stats ? &stats->searchMs : nullptr);
+        growSearchTree(tree);
+    }
+
+    bool morphFound = testBit(tree.discoveredWords, endWordIdx);
+    path.clear();
+    if (morphFound) {
+        for (int i = endWordIdx; i != -1; i = tree.prevWordIdx[i]) {
+            path.push_back(i);
+        }
+    } // else: the search ran out, having discovered the whole component
+    numDiscovered = tree.numDiscovered;
+
+    if (stats) {
+        stats->numSearches++;
+        stats->wordsDiscovered += static_cast<size_t>(numDiscovered);
+        stats->longestPath = std::max(stats->longestPath, path.size());
+    }
+
+    {
+        PhaseTimer timer(stats ? &stats->outputMs : nullptr);
+        printMorph(morphFound);
+    }
+    trimSearchTrees();
+} // answerFromTree()
+
+void LetterManClass::updateDictionary(std::vector<std::string> &command, 
+                                      std::unordered_map<std::string, std::vector<int>> &wordIndex) {
+    bool adding = command[0] == "+";
+    if (command.size() < 2) {
+        std::cout << "Update must name at least one word\n" << std::flush;
+        return;
+    }
+
+    // a paused search may already have passed the changed neighborhoods
+    searchTrees.clear();
+
+    for (size_t i = 1; i < command.size(); i++) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        auto wordIt = wordIndex.find(command[i]);
+        size_t numNeighbors = 0;
+
+        if (adding) {
+            if (dedupIsSpecified && wordIt != wordIndex.end()) {
+                std::cout << "Word already exists in the dictionary: " << command[i] << "\n";
+                continue;
+            } // --dedup keeps only the first copy
+            wordIndex[command[i]].push_back(static_cast<int>(numWords()));
+            numNeighbors = insertWord(command[i]);
+            std::cout << "Added " << command[i] << ", " << numNeighbors << " neighbors\n";
+        } // if adding, the word goes last as if appended to the dictionary
+        else {
+            if (wordIt == wordIndex.end()) {
+                std::cout << "Word does not exist in the dictionary: " << command[i] << "\n";
+                continue;
+            }
+            for (int wordIdx : wordIt->second) {
+                numNeighbors = eraseWord(wordIdx);
+            } // every copy has the same neighbors
+            wordIndex.erase(wordIt);
+            std::cout << "Removed " << command[i] << ", " << numNeighbors << " neighbors\n";
+        } // else: removing every copy of the word
+
+        double elapsedMs = std::chrono::duration<double, std::milli>(
+                               std::chrono::steady_clock::now() - start).count();
+        std::cerr << (adding ? "Adding " : "Removing ") << command[i] << " took " 
+                  << elapsedMs << " ms\n";
+        if (stats) {
+            stats->numUpdates++;
+            stats->updateMs += elapsedMs;
+        }
+    } // for (i)
+
+    std::cout << std::flush;
+} // updateDictionary()
+
+void LetterManClass::printStats() {
+    if (!stats) {
+        return;
+    }
+
+    const char *modeNames[] = {"change", "swap", "length"};
+    auto percent = [](size_t part, size_t whole) {
+        return whole == 0 ? 0.0 : 100.0 * static_cast<double>(part) / static_cast<double>(whole);
+    };
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+    std::cerr << "Stats:\n"
+              << "  read:          " << stats->readMs << " ms\n"
+              << "  filter:        " << stats->filterMs << " ms, " 
+              << stats->wordsFiltered << " words dropped\n"
+              << "  index:         " << stats->indexMs << " ms\n"
+              << "  cache write:   " << stats->cacheMs << " ms\n"
+              << "  search:        " << stats->searchMs << " ms in " 
+              << stats->numSearches << " searches\n"
+              << "  output:        " << stats->outputMs << " ms\n"
+              << "  updates:       " << stats->updateMs << " ms for " 
+              << stats->numUpdates << " words\n"
+              << "  words read:    " << stats->wordsRead << "\n"
+              << "  words kept:    " << numWords() << "\n"
+              << "  words discovered: " << stats->wordsDiscovered << "\n";
+
+    for (int mode = changeMode; mode <= lengthMode; mode++) {
+        size_t numChecks = stats->modeChecks[mode];
+        size_t numPasses = stats->modePasses[mode];
+        std::cerr << "  " << modeNames[mode] << " checks: " << numChecks 
+                  << ", passed " << numPasses << " (" 
+                  << percent(numPasses, numChecks) << "%)\n";
+    } // for (mode)
+
+    std::cerr << "  size rejections: " << stats->sizeRejections << "\n"
+              << "  peak search container: " << stats->peakContainerSize << "\n"
+              << "  longest path:  " << stats->longestPath << "\n"
+              << "  BFS levels:    " << stats->topDownLevels << " top-down, " 
+              << stats->bottomUpLevels << " bottom-up\n"
+              << "  peak RSS:      " << usage.ru_maxrss << " kB\n";
+} // printStats()
+
+bool AStarOrder::operator()(const AStarEntry &entryA, const AStarEntry &entryB) const {
+    if (entryA.estimate != entryB.estimate) {
+        return entryA.estimate > entryB.estimate;
+    }
+    if (entryA.depth != entryB.depth) {
+        return entryA.depth < entryB.depth;
+    }
+    return entryA.wordIdx > entryB.wordIdx;
+} // AStarOrder::operator()
+
+size_t WordIdxHash::operator()(uint32_t wordIdx) const {
+    return std::hash<std::string_view>()(letterman->wordAt(wordIdx));
+} // WordIdxHash::operator()
+
+bool WordIdxEqual::operator()(uint32_t wordIdxA, uint32_t wordIdxB) const {
+    return letterman->wordAt(wordIdxA) == letterman->wordAt(wordIdxB);
+} // WordIdxEqual::operator()